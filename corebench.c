@@ -0,0 +1,138 @@
+/** @file corebench.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "libcorescan/libcorescan.h"
+
+/*
+ * The scans libscheduler ran before libcorescan: one job record per core,
+ * reached through a pointer, and a comparator call per busy core.
+ */
+typedef struct _bench_job_t
+{
+	int arr_t, pri, other[14];
+} bench_job_t;
+
+int compare_pri(const void * a, const void * b)
+{
+	const bench_job_t *p1 = a, *p2 = b;
+	return (p1->pri == p2->pri) ? p1->arr_t - p2->arr_t : p1->pri - p2->pri;
+}
+
+int (*compare)(const void *, const void *) = compare_pri;
+
+int loop_first_idle(bench_job_t **jobs, int n)
+{
+	int i;
+	for (i = 0; i < n; i++)
+		if (jobs[i] == NULL)
+			return i;
+	return -1;
+}
+
+int loop_victim(bench_job_t **jobs, int n, bench_job_t *job)
+{
+	int i, x = -1, cmp = 0, cmp_n;
+	for (i = 0; i < n; i++)
+	{
+		cmp_n = compare(job, jobs[i]);
+		if (cmp_n < cmp)
+		{
+			cmp = cmp_n;
+			x = i;
+		}
+	}
+	return x;
+}
+
+double now()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+volatile int sink;
+
+/*
+ * Best of five timings of rounds evaluations of expr, in ns per evaluation.
+ */
+#define TIME(ns, expr)											\
+	do {														\
+		int t_;													\
+		for (t_ = 0, ns = -1; t_ < 5; t_++)						\
+		{														\
+			double t0_ = now(), d_;								\
+			for (r = 0; r < rounds; r++)						\
+				sink = (expr);									\
+			d_ = (now() - t0_) / rounds;						\
+			if (ns < 0 || d_ < ns)								\
+				ns = d_;										\
+		}														\
+	} while (0)
+
+int main(int argc, char **argv)
+{
+	int sizes[] = { 64, 256, 1024, 4096 };
+	corescan_impl_t impls[] = { CORESCAN_SCALAR, CORESCAN_SSE4, CORESCAN_AVX2 };
+	int reps = (argc > 1) ? atoi(argv[1]) : 50000;
+	int s, i, r, k;
+
+	srand(678);
+	printf("ns per scan, every core busy; the victim search has ~5%% candidates\n\n");
+	printf("%6s  %-8s %10s %10s %10s\n", "cores", "impl", "idle", "fastest", "victim");
+
+	for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		int n = sizes[s];
+		int rounds = (int)((long long)reps * 64 / n);
+		bench_job_t **recs = malloc(n * sizeof(bench_job_t *));
+		int *jobs = malloc(n * sizeof(int));
+		int *speed = malloc(n * sizeof(int));
+		long long *key = malloc(n * sizeof(long long));
+		int *out = malloc(n * sizeof(int));
+		bench_job_t job = { n, 5, { 0 } };
+		double idle_ns, fastest_ns, victim_ns;
+
+		for (i = 0; i < n; i++)
+		{
+			recs[i] = malloc(sizeof(bench_job_t) + (rand() % 4) * 64);
+			recs[i]->arr_t = i;
+			recs[i]->pri = rand() % 100;
+			jobs[i] = i;
+			speed[i] = 1000;
+			key[i] = recs[i]->pri;
+		}
+
+		TIME(idle_ns, loop_first_idle(recs, n));
+		TIME(victim_ns, loop_victim(recs, n, &job));
+
+		printf("%6d  %-8s %10.1f %10s %10.1f\n", n, "loop", idle_ns, "-", victim_ns);
+
+		for (k = 0; k < (int)(sizeof(impls) / sizeof(impls[0])); k++)
+		{
+			if (corescan_select(impls[k]) != impls[k])
+				continue;
+
+			TIME(idle_ns, corescan_first_idle(jobs, n));
+			TIME(fastest_ns, corescan_fastest_idle(jobs, speed, n));
+			TIME(victim_ns, corescan_above(key, n, job.pri, out));
+
+			printf("%6d  %-8s %10.1f %10.1f %10.1f\n", n, corescan_name(impls[k]), idle_ns, fastest_ns, victim_ns);
+		}
+		printf("\n");
+
+		for (i = 0; i < n; i++)
+			free(recs[i]);
+		free(recs);
+		free(jobs);
+		free(speed);
+		free(key);
+		free(out);
+	}
+
+	return 0;
+}
@@ -4,10 +4,21 @@
 # Adopted from CS 241 @ The University of Illinois
 
 for $file (<examples/*>){
-	if( $file =~ /proc(\d+)-c(\d+)-(\w+)\.out/){
+	if( $file =~ /proc(\d+)-c(\d+)-(\w+?)(-\w+)?\.out/){
 	#	print "Proc $1 CORE $2 Proc $3\n";
-		`./simulator -c $2 -s $3 examples/proc$1.csv | tail -7 > output1`;
-		`tail -7 $file > output2`;
+		($proc, $cores, $scheme, $tag) = ($1, $2, $3, $4);
+		if($tag){
+			# A tagged example runs with the options in its .opt file and is compared whole
+			($opt = $file) =~ s/\.out$/.opt/;
+			$opts = `cat $opt`;
+			chomp($opts);
+			`./simulator -c $cores -s $scheme $opts examples/proc$proc.csv > output1`;
+			`cp $file output2`;
+		}
+		else{
+			`./simulator -c $cores -s $scheme examples/proc$proc.csv | tail -7 > output1`;
+			`tail -7 $file > output2`;
+		}
 		$diff = `diff output1 output2`;
 		if($diff){
 			print "Test file $file differs\n$diff";
@@ -0,0 +1,339 @@
+/** @file libcorescan.c
+ */
+
+#include <stdlib.h>
+
+#include "libcorescan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CORESCAN_X86
+#include <immintrin.h>
+#endif
+
+static int (*first_idle_fn)(const int *, int);
+static int (*fastest_idle_fn)(const int *, const int *, int);
+static int (*above_fn)(const long long *, int, long long, int *);
+
+
+//	------------------------------------------------------------------------------------------
+//	Scalar
+//	------------------------------------------------------------------------------------------
+static int first_idle_scalar(const int *jobs, int n)
+{
+	int i;
+	for (i = 0; i < n; i++)
+		if (jobs[i] == -1)
+			return i;
+	return -1;
+}
+
+static int fastest_idle_scalar(const int *jobs, const int *speed, int n)
+{
+	int i, x = -1;
+	for (i = 0; i < n; i++)
+		if (jobs[i] == -1 && (x == -1 || speed[i] > speed[x]))
+			x = i;
+	return x;
+}
+
+static int above_scalar(const long long *key, int n, long long k, int *out)
+{
+	int i, m = 0;
+	for (i = 0; i < n; i++)
+		if (key[i] > k)
+			out[m++] = i;
+	return m;
+}
+
+
+#ifdef CORESCAN_X86
+//	Byte shuffles packing the lanes of four 32-bit indices picked by a 4-bit mask to the front
+static __m128i compress_tab[16];
+static const int compress_cnt[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+static void compress_init()
+{
+	unsigned char b[16];
+	int m, lane, c, j;
+	for (m = 0; m < 16; m++)
+	{
+		for (j = 0; j < 16; j++)
+			b[j] = 0x80;
+		for (lane = 0, c = 0; lane < 4; lane++)
+		{
+			if (!(m & (1 << lane)))
+				continue;
+			for (j = 0; j < 4; j++)
+				b[c * 4 + j] = lane * 4 + j;
+			c++;
+		}
+		compress_tab[m] = _mm_loadu_si128((const __m128i *)b);
+	}
+}
+
+
+//	------------------------------------------------------------------------------------------
+//	SSE4.2, four cores per step
+//	------------------------------------------------------------------------------------------
+__attribute__((target("sse4.2")))
+static int first_idle_sse4(const int *jobs, int n)
+{
+	int i = 0, m;
+	__m128i idle = _mm_set1_epi32(-1);
+	for (; i + 4 <= n; i += 4)
+	{
+		m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(jobs + i)), idle)));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	return (i < n && (m = first_idle_scalar(jobs + i, n - i)) != -1) ? i + m : -1;
+}
+
+__attribute__((target("sse4.2")))
+static int fastest_idle_sse4(const int *jobs, const int *speed, int n)
+{
+	int i, m, best;
+	__m128i idle = _mm_set1_epi32(-1);
+	__m128i v = idle;
+
+	// Greatest speed among idle cores, busy cores count as -1
+	for (i = 0; i + 4 <= n; i += 4)
+	{
+		__m128i mask = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(jobs + i)), idle);
+		__m128i s = _mm_blendv_epi8(idle, _mm_loadu_si128((const __m128i *)(speed + i)), mask);
+		v = _mm_max_epi32(v, s);
+	}
+	v = _mm_max_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_max_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	best = _mm_cvtsi128_si32(v);
+	for (; i < n; i++)
+		if (jobs[i] == -1 && speed[i] > best)
+			best = speed[i];
+	if (best == -1)
+		return -1;
+
+	// Then the lowest idle core running at it
+	__m128i want = _mm_set1_epi32(best);
+	for (i = 0; i + 4 <= n; i += 4)
+	{
+		__m128i mask = _mm_and_si128(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(jobs + i)), idle),
+				_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(speed + i)), want));
+		m = _mm_movemask_ps(_mm_castsi128_ps(mask));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	for (; i < n; i++)
+		if (jobs[i] == -1 && speed[i] == best)
+			return i;
+	return -1;
+}
+
+__attribute__((target("sse4.2")))
+static int above_sse4(const long long *key, int n, long long k, int *out)
+{
+	int i, m, c = 0;
+	__m128i kk = _mm_set1_epi64x(k);
+	__m128i idx = _mm_setr_epi32(0, 1, 2, 3), four = _mm_set1_epi32(4);
+
+	// Store all four indices every step, packed and advanced past only the ones that
+	// qualified; out + c never passes out + i, so the stores stay within n
+	for (i = 0; i + 4 <= n; i += 4)
+	{
+		m = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(_mm_loadu_si128((const __m128i *)(key + i)), kk)))
+				| _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(_mm_loadu_si128((const __m128i *)(key + i + 2)), kk))) << 2;
+		_mm_storeu_si128((__m128i *)(out + c), _mm_shuffle_epi8(idx, compress_tab[m]));
+		c += compress_cnt[m];
+		idx = _mm_add_epi32(idx, four);
+	}
+	for (; i < n; i++)
+		if (key[i] > k)
+			out[c++] = i;
+	return c;
+}
+
+
+//	------------------------------------------------------------------------------------------
+//	AVX2, eight cores (four 64-bit keys) per step
+//	------------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static int first_idle_avx2(const int *jobs, int n)
+{
+	int i = 0, m;
+	__m256i idle = _mm256_set1_epi32(-1);
+	for (; i + 8 <= n; i += 8)
+	{
+		m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(jobs + i)), idle)));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	return (i < n && (m = first_idle_scalar(jobs + i, n - i)) != -1) ? i + m : -1;
+}
+
+__attribute__((target("avx2")))
+static int fastest_idle_avx2(const int *jobs, const int *speed, int n)
+{
+	int i, m, best;
+	__m256i idle = _mm256_set1_epi32(-1);
+	__m256i v = idle;
+
+	// Greatest speed among idle cores, busy cores count as -1
+	for (i = 0; i + 8 <= n; i += 8)
+	{
+		__m256i mask = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(jobs + i)), idle);
+		__m256i s = _mm256_blendv_epi8(idle, _mm256_loadu_si256((const __m256i *)(speed + i)), mask);
+		v = _mm256_max_epi32(v, s);
+	}
+	__m128i h = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	h = _mm_max_epi32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2)));
+	h = _mm_max_epi32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(2, 3, 0, 1)));
+	best = _mm_cvtsi128_si32(h);
+	for (; i < n; i++)
+		if (jobs[i] == -1 && speed[i] > best)
+			best = speed[i];
+	if (best == -1)
+		return -1;
+
+	// Then the lowest idle core running at it
+	__m256i want = _mm256_set1_epi32(best);
+	for (i = 0; i + 8 <= n; i += 8)
+	{
+		__m256i mask = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(jobs + i)), idle),
+				_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(speed + i)), want));
+		m = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+		if (m)
+			return i + __builtin_ctz(m);
+	}
+	for (; i < n; i++)
+		if (jobs[i] == -1 && speed[i] == best)
+			return i;
+	return -1;
+}
+
+__attribute__((target("avx2")))
+static int above_avx2(const long long *key, int n, long long k, int *out)
+{
+	int i, m, c = 0;
+	__m256i kk = _mm256_set1_epi64x(k);
+	__m128i idx = _mm_setr_epi32(0, 1, 2, 3), four = _mm_set1_epi32(4);
+	for (i = 0; i + 4 <= n; i += 4)
+	{
+		m = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i *)(key + i)), kk)));
+		_mm_storeu_si128((__m128i *)(out + c), _mm_shuffle_epi8(idx, compress_tab[m]));
+		c += compress_cnt[m];
+		idx = _mm_add_epi32(idx, four);
+	}
+	for (; i < n; i++)
+		if (key[i] > k)
+			out[c++] = i;
+	return c;
+}
+#endif /* CORESCAN_X86 */
+
+
+/**
+	Picks the implementation of the core scans. CORESCAN_AUTO takes the
+	widest one the CPU supports; asking for an unsupported one falls back to
+	the next narrower. All implementations return identical results.
+
+	@param impl the implementation wanted
+	@return the implementation now in use
+ */
+corescan_impl_t corescan_select(corescan_impl_t impl)
+{
+#ifdef CORESCAN_X86
+	__builtin_cpu_init();
+	compress_init();
+	if (impl == CORESCAN_AUTO)
+		impl = CORESCAN_AVX2;
+	if (impl == CORESCAN_AVX2 && !__builtin_cpu_supports("avx2"))
+		impl = CORESCAN_SSE4;
+	if (impl == CORESCAN_SSE4 && !__builtin_cpu_supports("sse4.2"))
+		impl = CORESCAN_SCALAR;
+
+	if (impl == CORESCAN_AVX2)
+	{
+		first_idle_fn = first_idle_avx2;
+		fastest_idle_fn = fastest_idle_avx2;
+		above_fn = above_avx2;
+		return impl;
+	}
+	if (impl == CORESCAN_SSE4)
+	{
+		first_idle_fn = first_idle_sse4;
+		fastest_idle_fn = fastest_idle_sse4;
+		above_fn = above_sse4;
+		return impl;
+	}
+#endif
+	first_idle_fn = first_idle_scalar;
+	fastest_idle_fn = fastest_idle_scalar;
+	above_fn = above_scalar;
+	return CORESCAN_SCALAR;
+}
+
+
+/**
+	Returns the printable name of an implementation.
+
+	@param impl the implementation
+	@return its name
+ */
+const char *corescan_name(corescan_impl_t impl)
+{
+	switch (impl)
+	{
+		case CORESCAN_SCALAR:	return "scalar";
+		case CORESCAN_SSE4:		return "sse4.2";
+		case CORESCAN_AVX2:		return "avx2";
+		default:				return "auto";
+	}
+}
+
+
+/**
+	Returns the lowest index i with jobs[i] == -1, the first idle core.
+
+	@param jobs the job running on each core, -1 if idle
+	@param n the number of cores
+	@return the index of the first idle core, or -1 if every core is busy
+ */
+int corescan_first_idle(const int *jobs, int n)
+{
+	if (first_idle_fn == NULL)
+		corescan_select(CORESCAN_AUTO);
+	return first_idle_fn(jobs, n);
+}
+
+
+/**
+	Returns the idle core with the greatest speed, the lowest index among
+	equally fast ones.
+
+	@param jobs the job running on each core, -1 if idle
+	@param speed the speed of each core, positive
+	@param n the number of cores
+	@return the index of the fastest idle core, or -1 if every core is busy
+ */
+int corescan_fastest_idle(const int *jobs, const int *speed, int n)
+{
+	if (fastest_idle_fn == NULL)
+		corescan_select(CORESCAN_AUTO);
+	return fastest_idle_fn(jobs, speed, n);
+}
+
+
+/**
+	Collects, in increasing order, every index i with key[i] > k.
+
+	@param key the key of each core
+	@param n the number of cores
+	@param k the threshold
+	@param out where to store the indices, room for n of them
+	@return the number of indices stored
+ */
+int corescan_above(const long long *key, int n, long long k, int *out)
+{
+	if (above_fn == NULL)
+		corescan_select(CORESCAN_AUTO);
+	return above_fn(key, n, k, out);
+}
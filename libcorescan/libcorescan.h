@@ -0,0 +1,21 @@
+/** @file libcorescan.h
+ */
+
+#ifndef LIBCORESCAN_H_
+#define LIBCORESCAN_H_
+
+//
+//	Implementations of the core scans, picked at run time by default
+//
+typedef enum {CORESCAN_AUTO = 0, CORESCAN_SCALAR, CORESCAN_SSE4, CORESCAN_AVX2} corescan_impl_t;
+
+
+corescan_impl_t	corescan_select			(corescan_impl_t impl);
+const char*		corescan_name			(corescan_impl_t impl);
+
+int		corescan_first_idle		(const int *jobs, int n);
+int		corescan_fastest_idle	(const int *jobs, const int *speed, int n);
+int		corescan_above			(const long long *key, int n, long long k, int *out);
+
+
+#endif /* LIBCORESCAN_H_ */
@@ -0,0 +1,151 @@
+/** @file libhistogram.c
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libhistogram.h"
+
+/**
+	Returns the bucket holding v. Negative values are recorded as zero.
+*/
+int hist_index(int v)
+{
+	if (v < HIST_SUB_CNT)
+		return (v < 0) ? 0 : v;
+
+	int e = 31 - __builtin_clz((unsigned int)v);
+	return (e - HIST_SUB_BITS + 1) * HIST_SUB_CNT + ((v >> (e - HIST_SUB_BITS)) & (HIST_SUB_CNT - 1));
+}
+
+/**
+	Returns the largest value that maps to bucket i.
+*/
+int hist_upper(int i)
+{
+	if (i < HIST_SUB_CNT)
+		return i;
+
+	int shift = i / HIST_SUB_CNT - 1;
+	long long low = (long long)(HIST_SUB_CNT + i % HIST_SUB_CNT) << shift;
+	return (int)(low + (1LL << shift) - 1);
+}
+
+
+/**
+	Initializes the histogram_t data structure.
+
+	@param h a pointer to an instance of the histogram_t data structure
+ */
+void histogram_init(histogram_t *h)
+{
+	memset(h, 0, sizeof(histogram_t));
+}
+
+
+/**
+	Records one sample.
+
+	@param h a pointer to an instance of the histogram_t data structure
+	@param v the value to record
+ */
+void histogram_record(histogram_t *h, int v)
+{
+	h->cnt[hist_index(v)]++;
+	h->sum += v;
+	if (h->n == 0 || v < h->min)
+		h->min = v;
+	if (h->n == 0 || v > h->max)
+		h->max = v;
+	h->n++;
+
+	double d = v - h->mean;
+	h->mean += d / h->n;
+	h->m2 += d * (v - h->mean);
+}
+
+
+/**
+	Records n samples of the same value at once, eg. one per time unit it held.
+
+	@param h a pointer to an instance of the histogram_t data structure
+	@param v the value to record
+	@param n how many times to record it, nothing if below one
+ */
+void histogram_record_n(histogram_t *h, int v, long long n)
+{
+	if (n < 1)
+		return;
+
+	h->cnt[hist_index(v)] += n;
+	h->sum += v * n;
+	if (h->n == 0 || v < h->min)
+		h->min = v;
+	if (h->n == 0 || v > h->max)
+		h->max = v;
+	h->n += n;
+
+	double d = v - h->mean;
+	h->mean += d * n / h->n;
+	h->m2 += d * (v - h->mean) * n;
+}
+
+
+/**
+	Returns the value at quantile q. Values below HIST_SUB_CNT are exact;
+	larger ones are the upper edge of their bucket, never above the maximum.
+
+	@param h a pointer to an instance of the histogram_t data structure
+	@param q the quantile, between 0.0 and 1.0 (e.g. 0.99 for p99)
+	@return the value at quantile q
+	@return 0 if the histogram is empty
+ */
+int histogram_percentile(histogram_t *h, double q)
+{
+	if (h->n == 0)
+		return 0;
+
+	// Rank of the sample at quantile q, one-based
+	long long rank = (long long)ceil(q * h->n);
+	if (rank < 1)
+		rank = 1;
+
+	long long seen = 0;
+	int i;
+	for (i = 0; i < HIST_BUCKETS; i++)
+	{
+		seen += h->cnt[i];
+		if (seen >= rank)
+		{
+			int v = hist_upper(i);
+			if (v > h->max)
+				return h->max;
+			return (v < h->min) ? h->min : v;
+		}
+	}
+	return h->max;
+}
+
+
+/**
+	Returns the mean of all samples, computed from the exact 64-bit sum.
+
+	@param h a pointer to an instance of the histogram_t data structure
+	@return the mean, or 0.0 if the histogram is empty
+ */
+double histogram_mean(histogram_t *h)
+{
+	return (h->n == 0) ? 0.0 : (double)h->sum / h->n;
+}
+
+
+/**
+	Returns the population standard deviation of all samples.
+
+	@param h a pointer to an instance of the histogram_t data structure
+	@return the standard deviation, or 0.0 if the histogram is empty
+ */
+double histogram_stddev(histogram_t *h)
+{
+	return (h->n == 0) ? 0.0 : sqrt(h->m2 / h->n);
+}
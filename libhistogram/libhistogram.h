@@ -0,0 +1,40 @@
+/** @file libhistogram.h
+ */
+
+#ifndef LIBHISTOGRAM_H_
+#define LIBHISTOGRAM_H_
+
+//	Values below HIST_SUB_CNT get an exact bucket each; every power of two
+//	above that is split into HIST_SUB_CNT linear sub-buckets (< 6.25% error).
+#define HIST_SUB_BITS	4
+#define HIST_SUB_CNT	(1 << HIST_SUB_BITS)
+#define HIST_BUCKETS	(HIST_SUB_CNT * (32 - HIST_SUB_BITS))
+
+/**
+  Log-linear Histogram Data Structure
+*/
+typedef struct _histogram_t
+{
+	long long cnt[HIST_BUCKETS];
+	long long n;		//	Samples recorded
+	long long sum;		//	Exact sum of all samples
+	int min;
+	int max;
+
+	double mean;		//	Running mean and sum of squared deviations (Welford)
+	double m2;
+} histogram_t;
+
+
+void	histogram_init			(histogram_t *h);
+void	histogram_record		(histogram_t *h, int v);
+void	histogram_record_n		(histogram_t *h, int v, long long n);
+int		histogram_percentile	(histogram_t *h, double q);
+double	histogram_mean			(histogram_t *h);
+double	histogram_stddev		(histogram_t *h);
+
+int		hist_index				(int v);
+int		hist_upper				(int i);
+
+
+#endif /* LIBHISTOGRAM_H_ */
@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #include "libpriqueue.h"
+#include "../libprofile/libprofile.h"
 
 /**
 	Initializes the node_t data structure.
@@ -68,6 +69,585 @@ void* node_destroy(node_t* n)
 }
 
 
+/**
+	Compares two items with the queue's comparer, counting the call.
+*/
+static int pq_comp(priqueue_t *q, const void *a, const void *b)
+{
+	q->comps++;
+	return q->comp(a, b);
+}
+
+
+//=========================================//
+//	Red-Black tree backing store
+//=========================================//
+
+static int rb_size(rb_node_t* n) { return (n == NULL) ? 0 : n->size; }
+
+static rb_node_t* rb_min(rb_node_t* n)
+{
+	while (n->left != NULL)
+		n = n->left;
+	return n;
+}
+
+static rb_node_t* rb_next(rb_node_t* n)
+{
+	if (n->right != NULL)
+		return rb_min(n->right);
+
+	rb_node_t* p = n->parent;
+	while (p != NULL && n == p->right)
+	{
+		n = p;
+		p = p->parent;
+	}
+	return p;
+}
+
+static void rb_rotate_left(priqueue_t *q, rb_node_t* x)
+{
+	rb_node_t* y = x->right;
+	x->right = y->left;
+	if (y->left != NULL)
+		y->left->parent = x;
+	y->parent = x->parent;
+
+	if (x->parent == NULL)
+		q->root = y;
+	else if (x == x->parent->left)
+		x->parent->left = y;
+	else
+		x->parent->right = y;
+
+	y->left = x;
+	x->parent = y;
+
+	y->size = x->size;
+	x->size = rb_size(x->left) + rb_size(x->right) + 1;
+}
+
+static void rb_rotate_right(priqueue_t *q, rb_node_t* x)
+{
+	rb_node_t* y = x->left;
+	x->left = y->right;
+	if (y->right != NULL)
+		y->right->parent = x;
+	y->parent = x->parent;
+
+	if (x->parent == NULL)
+		q->root = y;
+	else if (x == x->parent->right)
+		x->parent->right = y;
+	else
+		x->parent->left = y;
+
+	y->right = x;
+	x->parent = y;
+
+	y->size = x->size;
+	x->size = rb_size(x->left) + rb_size(x->right) + 1;
+}
+
+/**
+	Inserts ptr into the tree. Equal elements are placed after existing
+	ones so ties keep insertion order, matching the list backing store.
+
+	@return the zero-based rank of the inserted element
+*/
+static int rb_offer(priqueue_t *q, void *ptr)
+{
+	rb_node_t* n = (rb_node_t*) malloc(sizeof(rb_node_t));
+	n->item = ptr;
+	n->red = 1;
+	n->size = 1;
+	n->left = NULL;
+	n->right = NULL;
+
+	rb_node_t* p = NULL;
+	rb_node_t* x = q->root;
+	int rank = 0, leftmost = 1, left = 0;
+	while (x != NULL)
+	{
+		p = x;
+		x->size++;
+		left = (pq_comp(q, ptr, x->item) < 0);
+		if (left)
+			x = x->left;
+		else
+		{
+			rank += rb_size(x->left) + 1;
+			leftmost = 0;
+			x = x->right;
+		}
+	}
+
+	n->parent = p;
+	if (p == NULL)
+		q->root = n;
+	else if (left)
+		p->left = n;
+	else
+		p->right = n;
+
+	if (leftmost)
+		q->leftmost = n;
+	q->queueSize++;
+
+	// Restore the red-black properties
+	while (n->parent != NULL && n->parent->red)
+	{
+		rb_node_t* g = n->parent->parent;
+		if (n->parent == g->left)
+		{
+			rb_node_t* u = g->right;
+			if (u != NULL && u->red)
+			{
+				n->parent->red = 0;
+				u->red = 0;
+				g->red = 1;
+				n = g;
+			}
+			else
+			{
+				if (n == n->parent->right)
+				{
+					n = n->parent;
+					rb_rotate_left(q, n);
+				}
+				n->parent->red = 0;
+				g->red = 1;
+				rb_rotate_right(q, g);
+			}
+		}
+		else
+		{
+			rb_node_t* u = g->left;
+			if (u != NULL && u->red)
+			{
+				n->parent->red = 0;
+				u->red = 0;
+				g->red = 1;
+				n = g;
+			}
+			else
+			{
+				if (n == n->parent->left)
+				{
+					n = n->parent;
+					rb_rotate_right(q, n);
+				}
+				n->parent->red = 0;
+				g->red = 1;
+				rb_rotate_left(q, g);
+			}
+		}
+	}
+	q->root->red = 0;
+
+	return rank;
+}
+
+static void rb_transplant(priqueue_t *q, rb_node_t* u, rb_node_t* v)
+{
+	if (u->parent == NULL)
+		q->root = v;
+	else if (u == u->parent->left)
+		u->parent->left = v;
+	else
+		u->parent->right = v;
+
+	if (v != NULL)
+		v->parent = u->parent;
+}
+
+/**
+	Unlinks z from the tree and frees it.
+
+	@return the item stored in z
+*/
+static void* rb_delete(priqueue_t *q, rb_node_t* z)
+{
+	rb_node_t *x, *xp, *y = z;
+	rb_node_t* p;
+	int y_red = y->red;
+
+	if (z == q->leftmost)
+		q->leftmost = rb_next(z);
+
+	// The spliced-out node is z itself or its successor
+	if (z->left != NULL && z->right != NULL)
+		y = rb_min(z->right);
+	for (p = y->parent; p != NULL; p = p->parent)
+		p->size--;
+
+	if (z->left == NULL)
+	{
+		x = z->right;
+		xp = z->parent;
+		rb_transplant(q, z, z->right);
+	}
+	else if (z->right == NULL)
+	{
+		x = z->left;
+		xp = z->parent;
+		rb_transplant(q, z, z->left);
+	}
+	else
+	{
+		y_red = y->red;
+		x = y->right;
+		if (y->parent == z)
+			xp = y;
+		else
+		{
+			xp = y->parent;
+			rb_transplant(q, y, y->right);
+			y->right = z->right;
+			y->right->parent = y;
+		}
+		rb_transplant(q, z, y);
+		y->left = z->left;
+		y->left->parent = y;
+		y->red = z->red;
+		y->size = z->size;
+	}
+
+	// Restore the red-black properties
+	if (!y_red)
+	{
+		while (x != q->root && (x == NULL || !x->red))
+		{
+			rb_node_t* w;
+			if (x == xp->left)
+			{
+				w = xp->right;
+				if (w->red)
+				{
+					w->red = 0;
+					xp->red = 1;
+					rb_rotate_left(q, xp);
+					w = xp->right;
+				}
+				if ((w->left == NULL || !w->left->red) && (w->right == NULL || !w->right->red))
+				{
+					w->red = 1;
+					x = xp;
+					xp = x->parent;
+				}
+				else
+				{
+					if (w->right == NULL || !w->right->red)
+					{
+						w->left->red = 0;
+						w->red = 1;
+						rb_rotate_right(q, w);
+						w = xp->right;
+					}
+					w->red = xp->red;
+					xp->red = 0;
+					if (w->right != NULL)
+						w->right->red = 0;
+					rb_rotate_left(q, xp);
+					x = q->root;
+				}
+			}
+			else
+			{
+				w = xp->left;
+				if (w->red)
+				{
+					w->red = 0;
+					xp->red = 1;
+					rb_rotate_right(q, xp);
+					w = xp->left;
+				}
+				if ((w->right == NULL || !w->right->red) && (w->left == NULL || !w->left->red))
+				{
+					w->red = 1;
+					x = xp;
+					xp = x->parent;
+				}
+				else
+				{
+					if (w->left == NULL || !w->left->red)
+					{
+						w->right->red = 0;
+						w->red = 1;
+						rb_rotate_left(q, w);
+						w = xp->left;
+					}
+					w->red = xp->red;
+					xp->red = 0;
+					if (w->left != NULL)
+						w->left->red = 0;
+					rb_rotate_right(q, xp);
+					x = q->root;
+				}
+			}
+		}
+		if (x != NULL)
+			x->red = 0;
+	}
+
+	q->queueSize--;
+	void* item = z->item;
+	free(z);
+	return item;
+}
+
+/**
+	Returns the node holding the index'th smallest element, or NULL.
+*/
+static rb_node_t* rb_select(priqueue_t *q, int index)
+{
+	rb_node_t* x = q->root;
+	while (x != NULL)
+	{
+		int l = rb_size(x->left);
+		if (index == l)
+			return x;
+		else if (index < l)
+			x = x->left;
+		else
+		{
+			index -= l + 1;
+			x = x->right;
+		}
+	}
+	return NULL;
+}
+
+
+//=========================================//
+//	Bucket (calendar) queue backing store
+//=========================================//
+
+/**
+	Returns the lowest non-empty bucket, or -1 if every bucket is empty.
+*/
+static int bk_first(priqueue_t *q)
+{
+	int w, words = (q->bucketCnt + 63) / 64;
+	for (w = 0; w < words; w++)
+		if (q->bitmap[w] != 0)
+			return w * 64 + __builtin_ctzll(q->bitmap[w]);
+	return -1;
+}
+
+/**
+	Returns the number of elements held in buckets below k.
+*/
+static int bk_rank(priqueue_t *q, int k)
+{
+	int w, rank = 0;
+	for (w = 0; w * 64 < k; w++)
+	{
+		unsigned long long bits = q->bitmap[w];
+		if (k - w * 64 < 64)
+			bits &= (1ULL << (k - w * 64)) - 1;
+
+		// Only visit the non-empty buckets
+		while (bits != 0)
+		{
+			rank += q->buckets[w * 64 + __builtin_ctzll(bits)].cnt;
+			bits &= bits - 1;
+		}
+	}
+	return rank;
+}
+
+/**
+	Appends ptr to the bucket for its key. Items within a bucket stay in
+	comparer order; an item that sorts before the tail (e.g. a preempted job
+	returning to the queue) is placed by a walk from the head.
+
+	@return the zero-based index of the inserted element
+*/
+static int bk_offer(priqueue_t *q, void *ptr)
+{
+	int k = q->key(ptr);
+	if (k < 0 || k >= q->bucketCnt)
+	{
+		printf("Error inserting node, key %d outside of 0..%d", k, q->bucketCnt - 1);
+		exit(1);
+	}
+
+	bucket_t* b = &q->buckets[k];
+	node_t* n = node_init();
+	insert(n, ptr);
+
+	int i = 0;
+	if (b->head == NULL)
+	{
+		b->head = n;
+		b->tail = n;
+		q->bitmap[k / 64] |= 1ULL << (k % 64);
+		i = 0;
+	}
+	else if (pq_comp(q, ptr, b->tail->item) >= 0)
+	{
+		// Common case, FIFO order
+		b->tail->next = n;
+		b->tail = n;
+		i = b->cnt;
+	}
+	else if (pq_comp(q, ptr, b->head->item) < 0)
+	{
+		insert_at(n, b->head);
+		b->head = n;
+		i = 0;
+	}
+	else
+	{
+		node_t* currentNode = b->head;
+		i = 1;
+		while (pq_comp(q, ptr, currentNode->next->item) >= 0)
+		{
+			currentNode = currentNode->next;
+			i++;
+		}
+		insert_at(n, currentNode->next);
+		currentNode->next = n;
+	}
+
+	b->cnt++;
+	q->queueSize++;
+	return bk_rank(q, k) + i;
+}
+
+/**
+	Unlinks the node after prev (or the head if prev is NULL) from bucket k.
+
+	@return the item stored in the node
+*/
+static void* bk_unlink(priqueue_t *q, int k, node_t* prev)
+{
+	bucket_t* b = &q->buckets[k];
+	node_t* n = (prev == NULL) ? b->head : prev->next;
+
+	if (prev == NULL)
+		b->head = n->next;
+	else
+		prev->next = n->next;
+	if (b->tail == n)
+		b->tail = prev;
+
+	if (--b->cnt == 0)
+		q->bitmap[k / 64] &= ~(1ULL << (k % 64));
+	q->queueSize--;
+	return node_destroy(n);
+}
+
+/**
+	Finds the index'th element; on return *k holds its bucket and *prev the
+	node before it within that bucket (NULL for the bucket head).
+*/
+static node_t* bk_select(priqueue_t *q, int index, int *k, node_t** prev)
+{
+	int w, words = (q->bucketCnt + 63) / 64;
+	for (w = 0; w < words; w++)
+	{
+		unsigned long long bits = q->bitmap[w];
+		while (bits != 0)
+		{
+			bucket_t* b = &q->buckets[w * 64 + __builtin_ctzll(bits)];
+			if (index < b->cnt)
+			{
+				*k = w * 64 + __builtin_ctzll(bits);
+				*prev = NULL;
+				node_t* n = b->head;
+				while (index-- > 0)
+				{
+					*prev = n;
+					n = n->next;
+				}
+				return n;
+			}
+			index -= b->cnt;
+			bits &= bits - 1;
+		}
+	}
+	return NULL;
+}
+
+
+//=========================================//
+//	Ring buffer backing store
+//=========================================//
+
+#define RING_AT(q, i)	((q)->ring[((q)->ringHead + (i)) & ((q)->ringCap - 1)])
+
+/**
+	Inserts ptr keeping comparer order. Elements which sort at or after the
+	tail, every element under FCFS and RR, are appended in O(1); any other
+	element is placed by binary search and the tail side is shifted up.
+
+	@return the zero-based index of the inserted element
+*/
+static int ring_offer(priqueue_t *q, void *ptr)
+{
+	int i, pos = q->queueSize;
+	if (q->queueSize == q->ringCap)
+	{
+		// Double the capacity, unwrapping the contents to start at zero
+		void** grown = (void**) malloc(sizeof(void*) * q->ringCap * 2);
+		for (i = 0; i < q->queueSize; i++)
+			grown[i] = RING_AT(q, i);
+		free(q->ring);
+		q->ring = grown;
+		q->ringCap *= 2;
+		q->ringHead = 0;
+	}
+
+	if (q->queueSize > 0 && pq_comp(q, ptr, RING_AT(q, q->queueSize - 1)) < 0)
+	{
+		// Find the first element ptr sorts before
+		int lo = 0, hi = q->queueSize - 1;
+		while (lo < hi)
+		{
+			int mid = (lo + hi) / 2;
+			if (pq_comp(q, ptr, RING_AT(q, mid)) < 0)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		pos = lo;
+
+		for (i = q->queueSize; i > pos; i--)
+			RING_AT(q, i) = RING_AT(q, i - 1);
+	}
+
+	RING_AT(q, pos) = ptr;
+	q->queueSize++;
+	return pos;
+}
+
+/**
+	Removes the index'th element, shifting whichever side is shorter.
+
+	@return the removed element
+*/
+static void* ring_remove_at(priqueue_t *q, int index)
+{
+	int i;
+	void* item = RING_AT(q, index);
+	if (index < q->queueSize / 2)
+	{
+		for (i = index; i > 0; i--)
+			RING_AT(q, i) = RING_AT(q, i - 1);
+		q->ringHead = (q->ringHead + 1) & (q->ringCap - 1);
+	}
+	else
+	{
+		for (i = index; i < q->queueSize - 1; i++)
+			RING_AT(q, i) = RING_AT(q, i + 1);
+	}
+	q->queueSize--;
+	return item;
+}
+
 /**
 	Initializes the priqueue_t data structure.
 	
@@ -83,6 +663,80 @@ void priqueue_init(priqueue_t *q, int(*comparer)(const void *, const void *))
 	q->head = NULL;
 	q->queueSize = 0;
 	q->comp = comparer;
+	q->type = PQ_LIST;
+	q->root = NULL;
+	q->leftmost = NULL;
+	q->comps = 0;
+	q->buckets = NULL;
+	q->bucketCnt = 0;
+	q->bitmap = NULL;
+	q->key = NULL;
+	q->ring = NULL;
+	q->ringCap = 0;
+	q->ringHead = 0;
+}
+
+
+/**
+	Initializes the priqueue_t data structure backed by a red-black tree
+	with a cached leftmost node.
+
+	Offers, polls and removals are O(log n) instead of the O(n) walk of
+	the list store; the public priqueue functions behave identically.
+	@param q a pointer to an instance of the priqueue_t data structure
+	@param comparer a function pointer that compares two elements.
+	See also @ref comparer-page
+ */
+void priqueue_init_rb(priqueue_t *q, int(*comparer)(const void *, const void *))
+{
+	priqueue_init(q, comparer);
+	q->type = PQ_RBTREE;
+}
+
+
+/**
+	Initializes the priqueue_t data structure as a bucket (calendar) queue
+	for elements whose order is decided first by a small integer key.
+
+	Each key has its own FIFO bucket and a bitmap tracks the non-empty ones,
+	so offer and poll are O(1) for in-order arrivals. The comparer still
+	breaks ties within a bucket, and must agree with the key ordering.
+	@param q a pointer to an instance of the priqueue_t data structure
+	@param comparer a function pointer that compares two elements.
+	See also @ref comparer-page
+	@param key a function pointer mapping an element to its bucket, 0 is served first
+	@param keys the number of buckets; key must return a value in 0..keys-1
+ */
+void priqueue_init_bucket(priqueue_t *q, int(*comparer)(const void *, const void *),
+                          int(*key)(const void *), int keys)
+{
+	priqueue_init(q, comparer);
+	q->type = PQ_BUCKET;
+	q->key = key;
+	q->bucketCnt = keys;
+	q->buckets = (bucket_t*) calloc(keys, sizeof(bucket_t));
+	q->bitmap = (unsigned long long*) calloc((keys + 63) / 64, sizeof(unsigned long long));
+}
+
+
+/**
+	Initializes the priqueue_t data structure backed by a growable ring
+	buffer, for queues whose elements nearly always arrive in order (FCFS
+	arrival order, RR re-queue order).
+
+	Appends and polls are O(1) with no per-element allocation, and
+	iteration walks contiguous memory. Out-of-order offers are still placed
+	correctly, at O(n) cost.
+	@param q a pointer to an instance of the priqueue_t data structure
+	@param comparer a function pointer that compares two elements.
+	See also @ref comparer-page
+ */
+void priqueue_init_fifo(priqueue_t *q, int(*comparer)(const void *, const void *))
+{
+	priqueue_init(q, comparer);
+	q->type = PQ_FIFO;
+	q->ringCap = 16;
+	q->ring = (void**) malloc(sizeof(void*) * q->ringCap);
 }
 
 
@@ -95,17 +749,25 @@ void priqueue_init(priqueue_t *q, int(*comparer)(const void *, const void *))
  */
 int priqueue_offer(priqueue_t *q, void *ptr)
 {
+	PROF_BEGIN(prof_t);
+	if (q->type == PQ_RBTREE)
+		PROF_RETURN(PROF_OFFER, prof_t, rb_offer(q, ptr));
+	else if (q->type == PQ_BUCKET)
+		PROF_RETURN(PROF_OFFER, prof_t, bk_offer(q, ptr));
+	else if (q->type == PQ_FIFO)
+		PROF_RETURN(PROF_OFFER, prof_t, ring_offer(q, ptr));
+
 	node_t* n = node_init();
 	insert(n, ptr);
 
 	if (q->head == NULL 
-		|| q->comp(n->item, q->head->item) < 0)
+		|| pq_comp(q, n->item, q->head->item) < 0)
 	{
 		// Store at the front of the queue
 		insert_at(n, q->head);
 		q->head = n;
 		q->queueSize++;
-		return 0;
+		PROF_RETURN(PROF_OFFER, prof_t, 0);
 	}
 	else
 	{
@@ -115,12 +777,12 @@ int priqueue_offer(priqueue_t *q, void *ptr)
 		while (i < priqueue_size(q))
 		{
 			if (currentNode->next == NULL 
-				|| q->comp(n->item, currentNode->next->item) < 0)
+				|| pq_comp(q, n->item, currentNode->next->item) < 0)
 			{
 				insert_at(n, currentNode->next);
 				currentNode->next = n;
 				q->queueSize++;
-				return i;
+				PROF_RETURN(PROF_OFFER, prof_t, i);
 			}
 			
 			currentNode = currentNode->next;
@@ -144,7 +806,13 @@ int priqueue_offer(priqueue_t *q, void *ptr)
  */
 void *priqueue_peek(priqueue_t *q)
 {
-	return (priqueue_size(q) == 0) ? NULL : q->head->item;
+	if (priqueue_size(q) == 0)
+		return NULL;
+	else if (q->type == PQ_BUCKET)
+		return q->buckets[bk_first(q)].head->item;
+	else if (q->type == PQ_FIFO)
+		return RING_AT(q, 0);
+	return (q->type == PQ_RBTREE) ? q->leftmost->item : q->head->item;
 }
 
 
@@ -158,16 +826,29 @@ void *priqueue_peek(priqueue_t *q)
  */
 void *priqueue_poll(priqueue_t *q)
 {
+	PROF_BEGIN(prof_t);
 	if (q->queueSize == 0)
 	{
-		return NULL;
+		PROF_RETURN(PROF_POLL, prof_t, NULL);
+	}
+	else if (q->type == PQ_RBTREE)
+	{
+		PROF_RETURN(PROF_POLL, prof_t, rb_delete(q, q->leftmost));
+	}
+	else if (q->type == PQ_BUCKET)
+	{
+		PROF_RETURN(PROF_POLL, prof_t, bk_unlink(q, bk_first(q), NULL));
+	}
+	else if (q->type == PQ_FIFO)
+	{
+		PROF_RETURN(PROF_POLL, prof_t, ring_remove_at(q, 0));
 	}
 	else
 	{
 		node_t* nodeToDelete = q->head;
 		q->head = nodeToDelete->next;
 		q->queueSize--;
-		return node_destroy(nodeToDelete);
+		PROF_RETURN(PROF_POLL, prof_t, node_destroy(nodeToDelete));
 	}
 }
 
@@ -188,6 +869,22 @@ void *priqueue_at(priqueue_t *q, int index)
 		// Index out of bounds
 		return NULL;
 	}
+	else if (q->type == PQ_RBTREE)
+	{
+		rb_node_t* n = rb_select(q, index);
+		return (n == NULL) ? NULL : n->item;
+	}
+	else if (q->type == PQ_BUCKET)
+	{
+		int k;
+		node_t* prev;
+		node_t* n = bk_select(q, index, &k, &prev);
+		return (n == NULL) ? NULL : n->item;
+	}
+	else if (q->type == PQ_FIFO)
+	{
+		return (index == priqueue_size(q)) ? NULL : RING_AT(q, index);
+	}
 	else
 	{
 		// Traverse the queue to get the correct item
@@ -216,6 +913,61 @@ void *priqueue_at(priqueue_t *q, int index)
 int priqueue_remove(priqueue_t *q, void *ptr)
 {
 	int numRemoved = 0;
+	if (q->type == PQ_RBTREE)
+	{
+		// In-order walk, unlinking every node holding ptr
+		rb_node_t* n = (q->root == NULL) ? NULL : rb_min(q->root);
+		while (n != NULL)
+		{
+			rb_node_t* next = rb_next(n);
+			if (n->item == ptr)
+			{
+				// Deleting n never frees or re-keys its successor
+				rb_delete(q, n);
+				numRemoved++;
+			}
+			n = next;
+		}
+		return numRemoved;
+	}
+	else if (q->type == PQ_BUCKET)
+	{
+		int k;
+		for (k = 0; k < q->bucketCnt; k++)
+		{
+			node_t* prev = NULL;
+			node_t* n = q->buckets[k].head;
+			while (n != NULL)
+			{
+				if (n->item == ptr)
+				{
+					n = n->next;
+					bk_unlink(q, k, prev);
+					numRemoved++;
+				}
+				else
+				{
+					prev = n;
+					n = n->next;
+				}
+			}
+		}
+		return numRemoved;
+	}
+	else if (q->type == PQ_FIFO)
+	{
+		// Compact the survivors towards the head
+		int i, j = 0;
+		for (i = 0; i < priqueue_size(q); i++)
+		{
+			if (RING_AT(q, i) != ptr)
+				RING_AT(q, j++) = RING_AT(q, i);
+		}
+		numRemoved = q->queueSize - j;
+		q->queueSize = j;
+		return numRemoved;
+	}
+
 	while (priqueue_size(q) > 0 && ptr == get_item(q->head))
 	{
 		priqueue_poll(q);
@@ -259,16 +1011,36 @@ int priqueue_remove(priqueue_t *q, void *ptr)
  */
 void *priqueue_remove_at(priqueue_t *q, int index)
 {
-	if (index < 0 || index > priqueue_size(q))
+	if (index < 0 || index >= priqueue_size(q))
 	{
 		// Index out of bounds
 		return NULL;
 	}
+	else if (q->type == PQ_RBTREE)
+	{
+		rb_node_t* n = rb_select(q, index);
+		return (n == NULL) ? NULL : rb_delete(q, n);
+	}
+	else if (q->type == PQ_BUCKET)
+	{
+		int k;
+		node_t* prev;
+		node_t* n = bk_select(q, index, &k, &prev);
+		return (n == NULL) ? NULL : bk_unlink(q, k, prev);
+	}
+	else if (q->type == PQ_FIFO)
+	{
+		return ring_remove_at(q, index);
+	}
+	else if (index == 0)
+	{
+		return priqueue_poll(q);
+	}
 	else
 	{
-		// Traverse the queue to remove the correct item
+		// Traverse the queue to the node before the one to remove
 		node_t* currentNode = q->head;
-		int i = 0;
+		int i = 1;
 		while (i < index)
 		{
 			currentNode = currentNode->next;
@@ -297,6 +1069,43 @@ int priqueue_size(priqueue_t *q)
 }
 
 
+/**
+	Calls fn on every element of the queue, in priority order.
+
+	@param q a pointer to an instance of the priqueue_t data structure
+	@param fn the function to call, given the element and arg
+	@param arg passed through to fn
+ */
+void priqueue_for_each(priqueue_t *q, void(*fn)(void *, void *), void *arg)
+{
+	int i, k;
+	if (q->type == PQ_FIFO)
+	{
+		for (i = 0; i < priqueue_size(q); i++)
+			fn(RING_AT(q, i), arg);
+	}
+	else if (q->type == PQ_RBTREE)
+	{
+		rb_node_t* n;
+		for (n = (q->root == NULL) ? NULL : rb_min(q->root); n != NULL; n = rb_next(n))
+			fn(n->item, arg);
+	}
+	else if (q->type == PQ_BUCKET)
+	{
+		node_t* n;
+		for (k = 0; k < q->bucketCnt; k++)
+			for (n = q->buckets[k].head; n != NULL; n = n->next)
+				fn(n->item, arg);
+	}
+	else
+	{
+		node_t* n;
+		for (n = q->head; n != NULL; n = n->next)
+			fn(n->item, arg);
+	}
+}
+
+
 /**
 	Destroys and frees all the memory associated with q.
 	
@@ -309,4 +1118,11 @@ void priqueue_destroy(priqueue_t *q)
 		// Keep removing the head of the queue until empty
 		priqueue_poll(q);
 	}
+
+	free(q->buckets);
+	free(q->bitmap);
+	free(q->ring);
+	q->buckets = NULL;
+	q->bitmap = NULL;
+	q->ring = NULL;
 }
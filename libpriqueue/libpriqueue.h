@@ -25,6 +25,45 @@ void*	node_destroy		(node_t* n);
 //=========================================//
 
 
+/**
+  Red-Black Tree Node Data Structure
+
+  Each node caches the size of its subtree so that positional lookups
+  (priqueue_at, priqueue_remove_at) stay logarithmic.
+*/
+typedef struct _rb_node_t
+{
+	void* item;
+	int red;
+	int size;
+	struct _rb_node_t* left;
+	struct _rb_node_t* right;
+	struct _rb_node_t* parent;
+} rb_node_t;
+
+
+//=========================================//
+
+
+/**
+  Bucket Data Structure, a FIFO of nodes sharing one key
+*/
+typedef struct _bucket_t
+{
+	node_t* head;
+	node_t* tail;
+	int cnt;
+} bucket_t;
+
+
+//=========================================//
+
+
+/**
+  Priqueue backing stores
+*/
+typedef enum {PQ_LIST = 0, PQ_RBTREE, PQ_BUCKET, PQ_FIFO} pq_type_t;
+
 /**
   Priqueue Data Structure
 */
@@ -33,10 +72,29 @@ typedef struct _priqueue_t
 	int queueSize;
 	node_t* head;
 	int (*comp) (const void*, const void*);
+
+	pq_type_t type;
+	rb_node_t* root;
+	rb_node_t* leftmost;	//	Cached minimum, makes peek/poll O(1) to find
+
+	long long comps;		//	Comparator calls made by this queue
+
+	bucket_t* buckets;		//	One FIFO per key, see priqueue_init_bucket
+	int bucketCnt;
+	unsigned long long* bitmap;	//	Bit k set while buckets[k] is non-empty
+	int (*key) (const void*);
+
+	void** ring;			//	Contiguous circular array, see priqueue_init_fifo
+	int ringCap;			//	Always a power of two
+	int ringHead;
 } priqueue_t;
 
 
 void   priqueue_init     (priqueue_t *q, int(*comparer)(const void *, const void *));
+void   priqueue_init_rb  (priqueue_t *q, int(*comparer)(const void *, const void *));
+void   priqueue_init_bucket(priqueue_t *q, int(*comparer)(const void *, const void *),
+                           int(*key)(const void *), int keys);
+void   priqueue_init_fifo(priqueue_t *q, int(*comparer)(const void *, const void *));
 
 int    priqueue_offer    (priqueue_t *q, void *ptr);
 void * priqueue_peek     (priqueue_t *q);
@@ -45,6 +103,7 @@ void * priqueue_at       (priqueue_t *q, int index);
 int    priqueue_remove   (priqueue_t *q, void *ptr);
 void * priqueue_remove_at(priqueue_t *q, int index);
 int    priqueue_size     (priqueue_t *q);
+void   priqueue_for_each (priqueue_t *q, void(*fn)(void *, void *), void *arg);
 
 void   priqueue_destroy  (priqueue_t *q);
 
@@ -0,0 +1,45 @@
+/** @file libprofile.c
+ */
+
+#include <stdio.h>
+#include <limits.h>
+
+#include "libprofile.h"
+#include "../libhistogram/libhistogram.h"
+
+#ifndef PROF_UNIT
+#define PROF_UNIT	"ticks"
+#endif
+
+static histogram_t prof_hist[PROF_SITES];
+static const char* prof_name[PROF_SITES] = { "new_job", "job_finished", "quantum_expired", "priqueue_offer", "priqueue_poll" };
+
+
+/**
+	Records the duration of one call.
+
+	@param site the instrumented call
+	@param ticks clock ticks the call took, clipped to INT_MAX
+ */
+void profile_record(prof_site_t site, uint64_t ticks)
+{
+	histogram_record(&prof_hist[site], (ticks > INT_MAX) ? INT_MAX : (int)ticks);
+}
+
+
+/**
+	Prints a table of the calls recorded at each site to stderr, then forgets them.
+ */
+void profile_report()
+{
+	int i;
+
+	fprintf(stderr, "\n%-16s %10s %8s %8s %8s %8s %8s %10s (%s)\n", "Profile", "calls", "min", "p50", "p90", "p99", "max", "mean", PROF_UNIT);
+	for (i = 0; i < PROF_SITES; i++)
+	{
+		histogram_t *h = &prof_hist[i];
+		fprintf(stderr, "%-16s %10lld %8d %8d %8d %8d %8d %10.1f\n", prof_name[i], h->n, h->min,
+				histogram_percentile(h, 0.50), histogram_percentile(h, 0.90), histogram_percentile(h, 0.99), h->max, histogram_mean(h));
+		histogram_init(h);
+	}
+}
@@ -0,0 +1,45 @@
+/** @file libprofile.h
+ */
+
+#ifndef LIBPROFILE_H_
+#define LIBPROFILE_H_
+#include <stdint.h>
+
+//	Decision-latency probes. Built with -DSCHED_PROFILE (make PROFILE=1) each probe records
+//	the clock ticks a call took into its site's histogram, and PROF_REPORT() prints them;
+//	otherwise every probe expands to nothing and the calls run exactly as before.
+
+//
+//	Instrumented calls
+//
+typedef enum {PROF_NEW_JOB = 0, PROF_JOB_FINISHED, PROF_QUANTUM_EXPIRED, PROF_OFFER, PROF_POLL, PROF_SITES} prof_site_t;
+
+
+void	profile_record		(prof_site_t site, uint64_t ticks);
+void	profile_report		();
+
+
+#ifdef SCHED_PROFILE
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROF_UNIT	"cycles"
+static inline uint64_t prof_clock() { return __rdtsc(); }
+#else
+#include <time.h>
+#define PROF_UNIT	"ns"
+static inline uint64_t prof_clock() { struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec; }
+#endif
+
+#define PROF_BEGIN(t)				uint64_t t = prof_clock()
+#define PROF_END(site, t)			profile_record(site, prof_clock() - (t))
+#define PROF_RETURN(site, t, expr)	do { __typeof__(expr) prof_r_ = (expr); PROF_END(site, t); return prof_r_; } while (0)
+#define PROF_REPORT()				profile_report()
+#else
+#define PROF_BEGIN(t)
+#define PROF_END(site, t)
+#define PROF_RETURN(site, t, expr)	return (expr)
+#define PROF_REPORT()
+#endif
+
+
+#endif /* LIBPROFILE_H_ */
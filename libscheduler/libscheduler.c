@@ -4,8 +4,82 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "libscheduler.h"
+#include "../libprofile/libprofile.h"
+
+//	------------------------------------------------------------------------------------------
+//	Global Var/Struct Definitions
+//	------------------------------------------------------------------------------------------
+priqueue_t* jobs;
+scheme_t sch_type;
+const policy_t* POLICY;
+core_t cores;
+job_table_t job_tab;
+int cur_t;
+
+//	Load weight per nice level (-20..19), each step is ~1.25x the CPU share
+static const int CFS_PRIO_TO_WGT[40] =
+{
+	88761,	71755,	56483,	46273,	36291,
+	29154,	23254,	18705,	14949,	11916,
+	9548,	7620,	6100,	4904,	3906,
+	3121,	2501,	1991,	1586,	1277,
+	1024,	820,	655,	526,	423,
+	335,	272,	215,	172,	137,
+	110,	87,		70,		56,		45,
+	36,		29,		23,		18,		15,
+};
+
+#define CFS_NICE_0_LOAD	1024
+#define CFS_MIN_GRAN	1
+
+int CFS_LATENCY = 6;			//	Target period in which every runnable job runs once
+long long CFS_LOAD = 0;			//	Sum of weights of all runnable jobs
+long long CFS_MIN_V = 0;		//	Monotonic floor of the queue's virtual runtimes
+
+long long SWITCH_N = 0;			//	Instrumentation counters, see scheduler_get_stats()
+long long PREEMPT_N = 0;
+long long REDISPATCH_N = 0;
+long long MIGRATE_N = 0;
+int DEPTH_MAX = 0;
+long long DEPTH_T = 0;			//	Queue depth integrated over time
+int SHOW_ON = 0;				//	Set once the queue is first shown, see scheduler_show_queue()
+int* SHOW_L = NULL;				//	Queued and running jobs in the order they are shown
+int SHOW_N = 0;
+int SHOW_CAP = 0;
+histogram_t DEPTH_H;			//	Queue depth of every time unit
+int STAT_T = 0;					//	Time of the last inc_time call
+
+int AGE_T = 0;					//	Time units waited per priority level gained, 0 disables aging
+int PRI_LO = 0;					//	Priority range announced by scheduler_set_priority_range()
+int PRI_HI = -1;
+int AFFINITY_W = 0;				//	Queue entries searched for a cache-warm job, 0 disables affinity
+int SWITCH_C = 0;				//	Stall of a core starting another job, see scheduler_set_switch_cost()
+int MIGRATE_C = 0;				//	Further stall of a job resumed on another core
+int GANG = 0;					//	Set under EASY or once a job spans several cores, see gang_fill()
+predict_t PRED_M = PREDICT_ORACLE;	//	Where ordering run times come from, see scheduler_set_prediction()
+double PRED_A = 0.5;			//	Weight of the newest run time in the exponential averages
+int ADMIT_ON = 0;				//	Set once any admission limit is in place
+int FAIR = 0;					//	Set once a tenant weight is given, see scheduler_set_tenant_weight()
+
+//	One tenant's queue and accounting
+typedef struct _tenant_t_
+{
+	int weight;				//	Share of the cores relative to other tenants
+	long long vserv;		//	Work its jobs received over weight, the least served tenant goes first
+	priqueue_t* q;			//	Its queued jobs under fair share, in the scheme's order
+	int run;				//	Cores running its jobs
+	long long cpu_t;		//	Core time its jobs received
+	histogram_t turn;		//	Turnaround of its finished jobs
+} tenant_t;
+
+tenant_t* TENANT = NULL;
+int TENANT_N = 0;
+int* TENANT_ORD = NULL;			//	Scratch list of tenants, see fair_order()
+int TENANT_ORD_N = 0;			//	Tenants the last fair_order() listed
+int FAIR_N = 0;					//	Jobs queued over every tenant under fair share
 
 //	------------------------------------------------------------------------------------------
 //	Scheduler Functions
@@ -23,13 +97,29 @@
 */
 void scheduler_start_up(int num_cores, scheme_t scheme)
 {
-	jobs = (priqueue_t*)malloc(sizeof(priqueue_t));
+	scheduler_start_up_policy(num_cores, scheduler_builtin_policy(scheme));
 	sch_type = scheme;
-	priqueue_init(jobs,&sch_time);
+	if ( scheme == EASY )
+		GANG = 1;
+}//scheduler_start_up
+
+
+/**
+	Initalizes the scheduler to run a policy of the caller's, in place of scheduler_start_up().
+
+	The policy is used from here on and must outlive the scheduler.
+	@param num_cores	the number of cores that is available by the scheduler.
+	@param policy	the policy to run, see policy_t.
+ */
+void scheduler_start_up_policy(int num_cores, const policy_t* policy)
+{
+	sch_type = PLUGIN;
+	POLICY = policy;
+	build_queue();
 	inc_time(0);
 
 	create_core(&cores,num_cores);
-}//scheduler_start_up
+}//scheduler_start_up_policy
 
 
 /**
@@ -53,25 +143,168 @@ void scheduler_start_up(int num_cores, scheme_t scheme)
  */
 int scheduler_new_job(int job_number, int time, int running_time, int priority)
 {
-	int i;
+	return scheduler_new_job_deadline(job_number, time, running_time, priority, -1);
+}//scheduler_new_job
+
+
+/**
+	Called when a new job with a completion deadline arrives.
+
+	Behaves exactly like scheduler_new_job(); the deadline is used by the EDF
+	and PEDF schemes for ordering and by every scheme for deadline accounting.
+	@param job_number a globally unique identification number of the job arriving.
+	@param time the current time of the simulator.
+	@param running_time the total number of time units this job will run before it will be finished.
+	@param priority the priority of the job. (The lower the value, the higher the priority.)
+	@param deadline the number of time units after arrival by which the job should finish, or -1 for none.
+	@return index of core job should be scheduled on
+	@return -1 if no scheduling changes should be made.
+ */
+int scheduler_new_job_deadline(int job_number, int time, int running_time, int priority, int deadline)
+{
+	return scheduler_new_job_gang(job_number, time, running_time, priority, deadline, 1);
+}//scheduler_new_job_deadline
+
+
+/**
+	Called when a new job which needs width cores at once arrives.
+
+	Once any such job arrives, or under EASY, jobs are gang scheduled: each
+	one runs on width cores together, taking the lowest idle ones, from start
+	to finish. Jobs start in queue order for as long as the head of the queue
+	fits; under EASY later jobs may also start early (backfill) when they fit
+	and would not delay the earliest time the head could start, as estimated
+	from the running jobs' remaining work. Gang jobs are never preempted, so
+	they are refused under the preemptive and time-sliced schemes.
+
+	A gang scheduled arrival may start other queued jobs as well;
+	scheduler_started_jobs() lists every job the call started.
+	@param job_number a globally unique identification number of the job arriving.
+	@param time the current time of the simulator.
+	@param running_time the total number of time units this job will run before it will be finished.
+	@param priority the priority of the job. (The lower the value, the higher the priority.)
+	@param deadline the number of time units after arrival by which the job should finish, or -1 for none.
+	@param width the number of cores the job runs on, at most the number of cores (see scheduler_set_max_cores()).
+	@return index of the lowest core job should be scheduled on
+	@return -1 if the job did not start.
+ */
+int scheduler_new_job_gang(int job_number, int time, int running_time, int priority, int deadline, int width)
+{
+	return scheduler_new_job_estimate(job_number, time, running_time, priority, deadline, width, -1, -1);
+}//scheduler_new_job_gang
+
+
+/**
+	Called when a new job arrives along with what is known of its run time
+	ahead of it running.
+
+	Behaves exactly like scheduler_new_job_gang(). Unless
+	scheduler_set_prediction() chose otherwise, running_time itself orders
+	the job; else it only serves the accounting, and the prediction made from
+	job_class or estimate is used instead.
+	@param job_number a globally unique identification number of the job arriving.
+	@param time the current time of the simulator.
+	@param running_time the total number of time units this job will run before it will be finished.
+	@param priority the priority of the job. (The lower the value, the higher the priority.)
+	@param deadline the number of time units after arrival by which the job should finish, or -1 for none.
+	@param width the number of cores the job runs on, at most the number of cores.
+	@param job_class the class of the job, a non-negative number, or -1 for none.
+	@param estimate the run time the submitter estimated, or -1 for none.
+	@return index of the lowest core job should be scheduled on
+	@return -1 if the job did not start.
+	@return JOB_REJECTED or JOB_DEFERRED if admission control refused the job.
+ */
+int scheduler_new_job_estimate(int job_number, int time, int running_time, int priority, int deadline, int width,
+							   int job_class, int estimate)
+{
+	return scheduler_new_job_tenant(job_number, time, running_time, priority, deadline, width, job_class, estimate, -1);
+}//scheduler_new_job_estimate
+
+
+/**
+	Called when a new job owned by a tenant arrives.
+
+	Behaves exactly like scheduler_new_job_estimate(). Under fair share (see
+	scheduler_set_tenant_weight()) the job waits in its tenant's own queue;
+	otherwise the tenant only serves the per-tenant statistics.
+	@param job_number a globally unique identification number of the job arriving.
+	@param time the current time of the simulator.
+	@param running_time the total number of time units this job will run before it will be finished.
+	@param priority the priority of the job. (The lower the value, the higher the priority.)
+	@param deadline the number of time units after arrival by which the job should finish, or -1 for none.
+	@param width the number of cores the job runs on, at most the number of cores.
+	@param job_class the class of the job, a non-negative number, or -1 for none.
+	@param estimate the run time the submitter estimated, or -1 for none.
+	@param tenant the tenant the job belongs to, below TENANTS_MAX, or -1 for none (tenant 0).
+	@return index of the lowest core job should be scheduled on
+	@return -1 if the job did not start.
+	@return JOB_REJECTED or JOB_DEFERRED if admission control refused the job.
+ */
+int scheduler_new_job_tenant(int job_number, int time, int running_time, int priority, int deadline, int width,
+							 int job_class, int estimate, int tenant)
+{
+	PROF_BEGIN(prof_t);
 	inc_time(time);
-	job_t* job = create_job(job_number, time, running_time, priority);
+	if ( ADMIT_ON && !admit_job(priority, ( PRED_M != PREDICT_ORACLE ) ? predict(job_class, estimate) : running_time) )
+		PROF_RETURN(PROF_NEW_JOB, prof_t, refuse_job(job_number, time, running_time, priority));
 
-	if ( (i = get_core()) != -1 )
+	// A deferred job keeps its record, and with it the time it first arrived
+	int job = job_number;
+	if ( is_deferred(job) )
 	{
-		insert_job(i,job);
-		return i;
+		JOB(job)->deferred = 0;
+		JOB(job)->wait_t = cur_t;
 	}//if
-	else if ( is_prempt() )
+	else
+		create_job(job_number, time, running_time, priority);
+	JOB(job)->cls = job_class;
+	JOB(job)->user_est = estimate;
+	if ( tenant >= TENANTS_MAX )
 	{
-		i = preempt(job);
-		if ( i == -1 )
-			priqueue_offer(jobs,job);
-		return i;
-	}//else if
-	priqueue_offer(jobs,job);
-	return -1;
-}//scheduler_new_job
+		printf("Job creation failed, job %d names tenant %d of at most %d", job_number, tenant, TENANTS_MAX);
+		exit(1);
+	}//if - tenants index the tenant table
+	JOB(job)->tenant = ( tenant > 0 ) ? tenant : 0;
+	if ( JOB(job)->tenant >= TENANT_N )
+		grow_tenant(JOB(job)->tenant + 1);
+	if ( FAIR )
+		fair_wake(JOB(job)->tenant);
+	if ( PRED_M != PREDICT_ORACLE )
+	{
+		JOB(job)->pred_t = predict(job_class, estimate);
+		JOB_EST(job) = (long long)JOB(job)->pred_t * SPEED_UNIT;
+	}//if
+	if ( jobs->type == PQ_BUCKET && (priority < PRI_LO || priority > PRI_HI) )
+	{
+		// Outside the announced range, fall back to the sorted list
+		PRI_HI = PRI_LO - 1;
+		build_queue();
+	}//if
+	JOB_DL(job) = (deadline < 0) ? -1 : JOB_ARR(job) + deadline;
+	if ( sch_type == CFS )
+	{
+		// Place new arrivals at the current minimum so they neither starve nor monopolize
+		cfs_update_min();
+		JOB_VRUN(job) = CFS_MIN_V;
+		CFS_LOAD += JOB(job)->wgt;
+	}//if
+
+	if ( width > 1 || GANG )
+	{
+		if ( width > cores.max || (width > 1 && (is_prempt() || POLICY->on_quantum != NULL)) )
+		{
+			printf("Gang job creation failed, job %d cannot run on %d cores", job_number, width);
+			exit(1);
+		}//if - too wide, or the scheme would preempt or time-slice part of a gang
+		GANG = 1;
+		JOB(job)->width = ( width > 1 ) ? width : 1;
+		cores.start_n = 0;
+		queue_offer(job);
+		gang_fill();
+		PROF_RETURN(PROF_NEW_JOB, prof_t, gang_lead(job));
+	}//if
+	PROF_RETURN(PROF_NEW_JOB, prof_t, place_job(job));
+}//scheduler_new_job_tenant
 
 
 /**
@@ -81,6 +314,9 @@ int scheduler_new_job(int job_number, int time, int running_time, int priority)
 	If any job should be scheduled to run on the core free'd up by the
 	finished job, return the job_number of the job that should be scheduled to
 	run on core core_id.
+	Under gang scheduling, call this once per job with any of its cores; every
+	core the job held is freed and scheduler_started_jobs() lists the jobs
+	started on them.
  
 	@param core_id the zero-based index of the core where the job was located.
 	@param job_number a globally unique identification number of the job.
@@ -90,30 +326,48 @@ int scheduler_new_job(int job_number, int time, int running_time, int priority)
  */
 int scheduler_job_finished(int core_id, int job_number, int time)
 {
+	int i;
+	PROF_BEGIN(prof_t);
+
 	// Increment Time
 	inc_time(time);
 
 	// Process job termination
-	job_t* p = delete_job(core_id,job_number);
-	priqueue_remove(jobs,p);
-	inc_wait(cur_t - p->arr_t - p->run_t);
-	inc_turn(cur_t - p->arr_t);
+	int p = remove_job(core_id,job_number);
+	if ( GANG )
+		for ( i=0; i < cores.cnt; i++ )
+			if ( cores.jobs[i] == p )
+				remove_job(i,p);
+	if ( sch_type == CFS )
+		CFS_LOAD -= JOB(p)->wgt;
+	inc_wait(cur_t - JOB_ARR(p) - JOB(p)->cpu_t);
+	inc_turn(cur_t - JOB_ARR(p));
+	histogram_record(&TENANT[JOB(p)->tenant].turn, cur_t - JOB_ARR(p));
+	inc_bsld(cur_t - JOB_ARR(p), JOB_RUN(p));
+	inc_pred(p);
+	if ( JOB_DL(p) != -1 )
+		inc_late(cur_t - JOB_DL(p));
 	free_job(p);
+
+	// Start whatever now fits on the freed cores
+	if ( GANG )
+	{
+		cores.start_n = 0;
+		gang_fill();
+		PROF_RETURN(PROF_JOB_FINISHED, prof_t, cores.jobs[core_id]);
+	}//if
 	
 	// Schedule new job
-	p = priqueue_poll(jobs);
-	if ( p != NULL )
-	{
+	p = next_job(core_id,-1);
+	if ( p != -1 )
 		insert_job(core_id,p);
-		return p->jid;
-	}//if
-	return -1;
+	PROF_RETURN(PROF_JOB_FINISHED, prof_t, p);
 }//scheduler_job_finished
 
 
 /**
-	When the scheme is set to RR, called when the quantum timer has expired
-	on a core.
+	When the scheme is set to RR or CFS, called when the quantum timer has
+	expired on a core.
  
 	If any job should be scheduled to run on the core free'd up by
 	the quantum expiration, return the job_number of the job that should be
@@ -125,231 +379,1964 @@ int scheduler_job_finished(int core_id, int job_number, int time)
  */
 int scheduler_quantum_expired(int core_id, int time)
 {
+	PROF_BEGIN(prof_t);
+
 	// Increment Time
 	inc_time(time);
 
 	// Process quantumn rollover
-	delete_job(core_id,cores.jobs[core_id]->jid);
+	int old = delete_job(core_id,cores.jobs[core_id]);
 	
 	// Schedule new job
-	job_t* p = priqueue_poll(jobs);
-	if ( p != NULL )
+	int p = next_job(core_id,old);
+	if ( p != -1 )
 	{
+		if ( p == cores.last[core_id] )
+			REDISPATCH_N++;
 		insert_job(core_id,p);
-		return p->jid;
 	}//if
-	return -1;
+	PROF_RETURN(PROF_QUANTUM_EXPIRED, prof_t, p);
 }//scheduler_quantum_expired
 
 //	------------------------------------------------------------------------------------------
-//	Timing Calculations
+//	Completely Fair Scheduling
 //	------------------------------------------------------------------------------------------
 
-float WAIT_T = 0;
-float RESP_T = 0;
-float TURN_T = 0;
+/**
+	Sets the CFS target latency, the period over which every runnable job
+	should receive one timeslice. Must be called before any job arrives.
 
-int WAIT_N = 0;
-int RESP_N = 0;
-int TURN_N = 0;
+	@param latency the target latency in time units. Values below one are ignored.
+ */
+void scheduler_set_latency(int latency)
+{
+	if ( latency > 0 )
+		CFS_LATENCY = latency;
+}//scheduler_set_latency
 
-void inc_wait(int t)	{ WAIT_N ++; WAIT_T += t; }
-void inc_resp(int t)	{ RESP_N ++; RESP_T += t; }
-void inc_turn(int t)	{ TURN_N ++; TURN_T += t; }
 
 /**
-	Returns the average waiting time of all jobs scheduled by your scheduler.
-	Assumptions:
-		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-	@return the average waiting time of all jobs scheduled.
+	Enables priority aging for the PRI and PPRI schemes: a queued job gains
+	one priority level for every age time units it waits, so a stream of
+	high-priority arrivals can no longer starve it indefinitely.
+
+	Aging is linear, so the order of two queued jobs never changes while both
+	wait; each job is keyed once as pri * age + (time it was queued) and the
+	queue is never re-sorted. A running job is keyed as if queued now.
+	@param age the time units per priority level, or 0 to disable aging.
  */
-float scheduler_average_waiting_time()
+void scheduler_set_aging(int age)
 {
-	return (WAIT_N == 0) ? 0.0 : (float)WAIT_T/WAIT_N;
-}//scheduler_average_waiting_time
+	AGE_T = ( age > 0 ) ? age : 0;
+	build_queue();
+}//scheduler_set_aging
 
 
 /**
-	Returns the average turnaround time of all jobs scheduled by your scheduler.
-	Assumptions:
-		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-	@return the average turnaround time of all jobs scheduled.
+	Announces the range of priorities jobs will carry. Under PRI and PPRI
+	without aging, a range of at most PRI_BUCKETS_MAX values lets the job
+	queue use one FIFO bucket per priority, making offer and poll O(1)
+	instead of a sorted-list walk. A job arriving outside the range moves
+	the queue back to the sorted list.
+	@param lo the lowest (most urgent) priority value.
+	@param hi the highest (least urgent) priority value.
  */
-float scheduler_average_turnaround_time()
+void scheduler_set_priority_range(int lo, int hi)
 {
-	return (TURN_N==0) ? 0.0 : (float)TURN_T/TURN_N;
-}//scheduler_average_turnaround_time
+	PRI_LO = lo;
+	PRI_HI = hi;
+	build_queue();
+}//scheduler_set_priority_range
 
 
 /**
-	Returns the average response time of all jobs scheduled by your scheduler.
-	Assumptions:
-		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-	@return the average response time of all jobs scheduled.
+	Enables affinity-aware dispatch. When a core frees up, the first window
+	jobs in the queue are searched for one that last ran on that core, whose
+	cache is most likely still warm; if none did, the head of the queue runs
+	as usual. A window of 1 or less keeps strict queue order.
+	@param window the number of queue entries to search.
  */
-float scheduler_average_response_time()
+void scheduler_set_affinity(int window)
 {
-	return (RESP_N == 0) ? 0.0 : (float)RESP_T/RESP_N;
-}//scheduler_average_response_time
+	AFFINITY_W = ( window > 1 ) ? window : 0;
+}//scheduler_set_affinity
 
 
 /**
-	Free any memory associated with your scheduler.
- 
-	Assumptions:
-	- This function will be the last function called in your library.
-*/
-void scheduler_clean_up()
+	Sets the cost of a context switch, matching the simulator's -o and -m. A core
+	starting a job other than the one it last ran stalls for switch_cost time
+	units, and a job resumed on another core a further migrate_cost; a stalled
+	job holds its core but retires no work, so its remaining time stays put.
+	@param switch_cost time units a core stalls when it switches jobs.
+	@param migrate_cost time units a job stalls when it changes cores.
+ */
+void scheduler_set_switch_cost(int switch_cost, int migrate_cost)
 {
-	void* p = NULL;
-	
-	while( (p = priqueue_poll(jobs)) != NULL )
-		free_job((job_t*)p);
-	
-	priqueue_destroy(jobs);
-	free(jobs);
-	free_core(&cores);
-}//scheduler_clean_up
+	SWITCH_C = ( switch_cost > 0 ) ? switch_cost : 0;
+	MIGRATE_C = ( migrate_cost > 0 ) ? migrate_cost : 0;
+}//scheduler_set_switch_cost
 
 
 /**
-	This function may print out any debugging information you choose. This
-	function will be called by the simulator after every call the simulator
-	makes to your scheduler.
-	In our provided output, we have implemented this function to list the jobs in the order they are to be scheduled. Furthermore, we have also listed the current state of the job (either running on a given core or idle). For example, if we have a non-preemptive algorithm and job(id=4) has began running, job(id=2) arrives with a higher priority, and job(id=1) arrives with a lower priority, the output in our sample output will be:
-		2(-1) 4(0) 1(-1)	
+	Sets the relative speed of a core, the amount of run time it retires per
+	time unit; 1.0 is a nominal core, 2.0 a core twice as fast.
 
-	This function is not required and will not be graded. You may leave it
-	blank if you do not find it useful.
+	Once cores differ in speed, a new job takes the fastest idle core and
+	preempts the job on the fastest core it outranks, so short or
+	high-priority jobs gravitate to fast cores. Only cores online are
+	compared; an offline core keeps its speed for when it comes back.
+	@param core_id the zero-based index of the core.
+	@param speed the speed factor, must be positive.
  */
-void scheduler_show_queue()
+void scheduler_set_core_speed(int core_id, float speed)
 {
+	cores.speed[core_id] = (int)(speed * SPEED_UNIT + 0.5f);
+	if ( cores.speed[core_id] < 1 )
+		cores.speed[core_id] = 1;
+	hetero_core();
+}//scheduler_set_core_speed
 
-}
 
-//	------------------------------------------------------------------------------------------
-//	Custom Helper Functions
-//	------------------------------------------------------------------------------------------
-void	free_job	(job_t* p)			{ free(p); }
-void	free_core	(core_t *p)			{ free(p->jobs); }
-int		is_prempt	()					{ if ( sch_type == PPRI || sch_type == PSJF ) { return 1; } return 0; }
-int		get_core	()					{	int i;
-											for(i=0;i<cores.cnt;i++) { if ( cores.jobs[i] == NULL ) { return i; } }
-											return -1;
-										}
-void	create_core	(core_t *p, int x)	{	int i;
-											p->cnt = x;
-											p->jobs = ( job_t** )malloc(sizeof(job_t*)*x);
-											for( i=0; i < x; i++) p->jobs[i] = NULL;
-										}
-job_t*	create_job	(int j, int a, int r, int pr)
-{
-	job_t* p = ( job_t* )malloc(sizeof(job_t)); 
-	p->arr_t = a;
-	p->run_t = r;
-	p->rem_t = r;
-	p->pri = pr;
-	p->jid = j;
-	p->init_core_t = -1;
-	p->updt_core_t = -1;
-	return p;
-}
+/**
+	Returns the timeslice the job currently running on core_id should receive.
 
-job_t* insert_job(int x, job_t* job)
+	Under CFS the target latency is split among all runnable jobs in
+	proportion to their weight, so the slice shrinks as the queue grows and
+	never drops below the minimum granularity. Under RR every slice is the
+	caller's quantum.
+	@param core_id the zero-based index of the core.
+	@return the length of the timeslice in time units
+	@return -1 if the core is idle, the scheme does not use timeslices or the caller's quantum applies
+ */
+int scheduler_time_slice(int core_id)
 {
-	if ( cores.jobs[x] != NULL )
-	{
-		printf("Job insertion failed on core: %d", x);
-		exit(1);
-	}//if - core isn't empty
+	int job = cores.jobs[core_id];
+	if ( POLICY->on_quantum == NULL || job == -1 )
+		return -1;
+	return POLICY->on_quantum(core_id, job);
+}//scheduler_time_slice
 
-	cores.jobs[x] = job;
-	job->updt_core_t = cur_t;
-	return job;
-}//insert_job
+int cfs_slice(int core_id, int job)
+{
+	if ( CFS_LOAD == 0 )
+		return -1;
 
-job_t* delete_job(int core, int id)
+	int i, nr = queue_size();
+	for ( i=0; i < cores.cnt; i++ )
+		if ( cores.jobs[i] != -1 )
+			nr++;
+
+	// Stretch the period once the queue is too deep to honour the latency
+	long long period = CFS_LATENCY;
+	if ( nr > CFS_LATENCY / CFS_MIN_GRAN )
+		period = (long long)nr * CFS_MIN_GRAN;
+
+	long long slice = period * JOB(job)->wgt / CFS_LOAD;
+	return ( slice < CFS_MIN_GRAN ) ? CFS_MIN_GRAN : (int)slice;
+}//cfs_slice
+
+int rr_slice(int core_id, int job) { return -1; }
+
+void cfs_update_min()
 {
-	if ( cores.jobs[core]->jid != id )
+	int i, p, found = 0;
+	long long v = 0;
+
+	// Under fair share every tenant's head is a candidate
+	for ( i=0; i < (FAIR ? TENANT_N : 1); i++ )
 	{
-		printf("Delete job failed, invaild job ID");
-		exit(1);
-	}//if - attempt to remove invalid job from core
+		p = JOB_ID(priqueue_peek(FAIR ? TENANT[i].q : jobs));
+		if ( p != -1 && (!found || JOB_VRUN(p) < v) )
+		{
+			v = JOB_VRUN(p);
+			found = 1;
+		}//if
+	}//for
 
-	job_t* job = cores.jobs[core];
-	job->updt_core_t = -1;
-	cores.jobs[core] = NULL;
-	priqueue_offer(jobs,job);
-	return job;
-}//delete_job
+	for ( i=0; i < cores.cnt; i++ )
+	{
+		if ( cores.jobs[i] != -1 && (!found || JOB_VRUN(cores.jobs[i]) < v) )
+		{
+			v = JOB_VRUN(cores.jobs[i]);
+			found = 1;
+		}//if
+	}//for
+
+	if ( found && v > CFS_MIN_V )
+		CFS_MIN_V = v;
+}//cfs_update_min
+
+//	------------------------------------------------------------------------------------------
+//	Gang Scheduling
+//	------------------------------------------------------------------------------------------
+
+/**
+	Fills in the cores a running job occupies, lowest first.
+	@param job_number the job.
+	@param core_ids where to store the core indices, room for one per core.
+	@return the number of cores stored, 0 if the job is not running.
+ */
+int scheduler_job_cores(int job_number, int* core_ids)
+{
+	int i, n = 0;
+	for ( i=0; i < cores.cnt; i++ )
+		if ( cores.jobs[i] == job_number )
+			core_ids[n++] = i;
+	return n;
+}//scheduler_job_cores
+
+
+/**
+	Fills in the jobs the most recent scheduler_new_job_gang(),
+	scheduler_job_finished(), scheduler_core_online() or
+	scheduler_core_offline() call started under gang scheduling, in the
+	order they started. Outside gang scheduling no jobs are listed.
+	@param job_numbers where to store the jobs, room for one per core.
+	@return the number of jobs stored.
+ */
+int scheduler_started_jobs(int* job_numbers)
+{
+	memcpy(job_numbers, cores.start, sizeof(int)*cores.start_n);
+	return cores.start_n;
+}//scheduler_started_jobs
 
-int preempt(job_t* job)
+int gang_idle()
 {
-	int cmp_n, cmp = 0;
-	int i, x = -1;
+	int i, n = 0;
 	for ( i=0; i < cores.cnt; i++ )
+		if ( cores.jobs[i] == -1 )
+			n++;
+	return n;
+}//gang_idle
+
+int gang_lead(int job)
+{
+	return ( JOB(job)->updt_core_t != -1 ) ? JOB(job)->lead : -1;
+}//gang_lead
+
+void gang_start(int job)
+{
+	int i, n = JOB(job)->width;
+
+	// The lowest core leads, inc_time() advances the job at its speed
+	for ( i=0; i < cores.cnt && n > 0; i++ )
 	{
-		cmp_n = sch_time(job, cores.jobs[i]);
-		if ( cmp_n < cmp )
+		if ( cores.jobs[i] == -1 )
 		{
-			cmp = cmp_n;
-			x = i;
+			if ( n < JOB(job)->width )
+				JOB(job)->last_core = -1;	//	Spreading over cores is not a migration
+			insert_job(i,job);
+			n--;
 		}//if
-		else if ( cmp_n == cmp )
+	}//for
+	cores.start[cores.start_n++] = job;
+}//gang_start
+
+void gang_fill()
+{
+	int i, n, p, s, w, c, head, idle = gang_idle();
+
+	// Start jobs in queue order for as long as the head fits
+	while ( (head = queue_peek()) != -1 && JOB(head)->width <= idle )
+	{
+		queue_poll();
+		gang_start(head);
+		idle -= JOB(head)->width;
+	}//while
+	if ( head == -1 || idle == 0 || sch_type != EASY )
+		return;
+
+	// EASY: the head is due at the shadow time, when enough running cores will have freed up;
+	// a gang frees all its cores at once, when its lead core's speed has retired its work
+	for ( i=0, n=0; i < cores.cnt; i++ )
+	{
+		p = cores.jobs[i];
+		if ( p != -1 && JOB(p)->lead == i )
 		{
-			if ( x != -1 && cores.jobs[x]->arr_t < cores.jobs[i]->arr_t )
-				x = i;
-		}//else if
+			cores.due[i] = cur_t + (int)((pred_rem(p) + cores.speed[i] - 1) / cores.speed[i]);
+			cores.cand[n++] = i;
+		}//if
 	}//for
+	qsort(cores.cand, n, sizeof(int), &due_cmp);
 
-	// insert job into core list.
-	if ( x >= 0 )
+	int shadow = cur_t, avail = idle;
+	for ( i=0; i < n && avail < JOB(head)->width; i++ )
 	{
-		delete_job(x,cores.jobs[x]->jid);
-		insert_job(x,job);
-	}//if
+		shadow = cores.due[cores.cand[i]];
+		avail += JOB(cores.jobs[cores.cand[i]])->width;
+	}//for
+	for ( ; i < n && cores.due[cores.cand[i]] == shadow; i++ )
+		avail += JOB(cores.jobs[cores.cand[i]])->width;
+	int extra = avail - JOB(head)->width;		//	Cores the head leaves spare at the shadow time
 
-	return x;
-}//preempt
+	// Backfill later jobs which fit now and either finish by the shadow time or use spare cores;
+	// gang_start() hands each the lowest idle cores left, and it is timed on the slowest of them
+	for ( i=0, n=0; i < cores.cnt; i++ )
+		if ( cores.jobs[i] == -1 )
+			cores.cand[n++] = i;
+	queue_walk();
+	for ( i=1, c=0; i < queue_size() && idle > 0; )
+	{
+		p = queue_at(i);
+		w = JOB(p)->width;
+		if ( w > idle )
+		{
+			i++;
+			continue;
+		}//if - too wide for the cores left
+		s = gang_slowest(c,w);
+		int end = cur_t + (int)((JOB_EST(p) + s - 1) / s);
+		if ( end <= shadow || w <= extra )
+		{
+			if ( end > shadow )
+				extra -= w;
+			queue_remove_at(i);
+			gang_start(p);
+			c += w;
+			idle -= w;
+		}//if
+		else
+			i++;
+	}//for
+}//gang_fill
+
+//	Speed of the slowest of the w idle cores listed in cores.cand from first on
+int gang_slowest(int first, int w)
+{
+	int i, s = INT_MAX;
+	for ( i=first; i < first + w; i++ )
+		if ( cores.speed[cores.cand[i]] < s )
+			s = cores.speed[cores.cand[i]];
+	return s;
+}//gang_slowest
 
-int sch_time(const void * p1v, const void * p2v)
+int due_cmp(const void * p1, const void * p2)
 {
-	job_t* p1 = (job_t*)p1v;
-	job_t* p2 = (job_t*)p2v;
-	int job_arr_t = (int)(p1->arr_t - p2->arr_t);
-	if ( sch_type == FCFS )
-		return job_arr_t;
-	else if ( sch_type == SJF )
-		return ((int)(p1->run_t - p2->run_t) == 0) ? job_arr_t : (int)(p1->run_t - p2->run_t);
-	else if ( sch_type == PSJF )
-		return ((int)(p1->rem_t - p2->rem_t) == 0) ? job_arr_t : (int)(p1->rem_t - p2->rem_t);
-	else if ( sch_type == PRI )
-		return ((int)(p1->pri - p2->pri) == 0) ? job_arr_t : (int)(p1->pri - p2->pri);
-	else if ( sch_type == PPRI )
-		return ((int)(p1->pri - p2->pri) == 0) ? job_arr_t : (int)(p1->pri - p2->pri);
-	return 0;
+	return cores.due[*(const int*)p1] - cores.due[*(const int*)p2];
 }
 
-void inc_time(int t)
+//	------------------------------------------------------------------------------------------
+//	Core Hotplug
+//	------------------------------------------------------------------------------------------
+
+/**
+	Announces the most cores that will ever be online at once, so gang jobs
+	that wide are accepted before enough cores have come online. Only sizes
+	the core arrays; cores come online through scheduler_core_online().
+	@param cores_n the most cores that will be online. Values no larger than before are ignored.
+ */
+void scheduler_set_max_cores(int cores_n)
 {
-	int i;
-	cur_t = t;
-	for ( i=0 ;i < cores.cnt; i++ )
+	if ( cores_n > cores.max )
+		grow_core(&cores,cores_n);
+}//scheduler_set_max_cores
+
+
+/**
+	Brings one more core online and gives it work straight away.
+
+	The new core is core(id=n), n being the number of cores online before
+	the call, and runs at the speed last set for it, nominal by default. It
+	takes the job the queue would hand a freed core; under gang scheduling
+	every job which now fits starts, as listed by scheduler_started_jobs().
+	@param time the current time of the simulator.
+	@return job_number of the job that should be scheduled to run on the new core
+	@return -1 if the new core should remain idle.
+ */
+int scheduler_core_online(int time)
+{
+	inc_time(time);
+	if ( cores.cnt == cores.max )
+		grow_core(&cores,cores.max + 1);
+	int c = cores.cnt++;
+	hetero_core();
+
+	if ( GANG )
 	{
-		// Catch temp job
-		job_t* job = cores.jobs[i];
-		if ( job )	
-		{
-			// if jobs is idle and not recently updated, get it scheduled and update response time
-			if ( (job->init_core_t == -1) && (job->updt_core_t != cur_t) )
-			{
-				job->init_core_t = job->updt_core_t;
-				inc_resp(job->init_core_t - job->arr_t);
-			}//if
+		cores.start_n = 0;
+		gang_fill();
+		return cores.jobs[c];
+	}//if
 
-			// Update remaining times for running jobs
-			job->rem_t -= cur_t - job->updt_core_t;
-			job->updt_core_t = cur_t;
+	int p = next_job(c,-1);
+	if ( p != -1 )
+		insert_job(c,p);
+	return p;
+}//scheduler_core_online
+
+
+/**
+	Takes the highest numbered core offline.
+
+	A job running on it is handed back as if it had just arrived: it takes an
+	idle core if there is one, preempts under the preemptive schemes, or else
+	waits in the queue. Under gang scheduling the job leaves every core it
+	held and rejoins the queue, after which whatever fits starts, as listed by
+	scheduler_started_jobs(). Core 0 never goes offline.
+	@param time the current time of the simulator.
+	@return index of the core the displaced job should now run on, its lowest under gang scheduling
+	@return -1 if the core was idle or its job now waits in the queue.
+ */
+int scheduler_core_offline(int time)
+{
+	int i;
+	inc_time(time);
+	if ( cores.cnt == 1 )
+	{
+		printf("Core offline failed, core 0 is the last core online");
+		exit(1);
+	}//if - keep a core to run on
+
+	// Take the job off every core it holds, then the core itself
+	int p = cores.jobs[cores.cnt - 1];
+	for ( i=0; p != -1 && i < cores.cnt; i++ )
+		if ( cores.jobs[i] == p )
+			remove_job(i,p);
+	cores.cnt--;
+	hetero_core();
+
+	if ( GANG )
+		cores.start_n = 0;
+	if ( p == -1 )
+		return -1;
+	JOB(p)->wait_t = cur_t;
+
+	if ( GANG )
+	{
+		queue_offer(p);
+		gang_fill();
+		return gang_lead(p);
+	}//if
+	return place_job(p);
+}//scheduler_core_offline
+
+//	------------------------------------------------------------------------------------------
+//	Run Time Prediction
+//	------------------------------------------------------------------------------------------
+
+double* CLASS_AVG = NULL;		//	Exponential average run time per class, negative until one finishes
+int CLASS_N = 0;
+double RUN_AVG = -1;			//	The same over every job
+double EST_RATIO = 1.0;			//	Exponential average of run time over the submitter's estimate
+
+long long PRED_N = 0;			//	Jobs finished
+double PRED_ERR = 0;			//	Sum of their absolute prediction errors
+double PRED_BIAS = 0;			//	Sum of their signed prediction errors
+
+/**
+	Chooses what SJF, PSJF and EASY take as a job's run time. PREDICT_ORACLE
+	uses the true running time. PREDICT_CLASS predicts the exponential average
+	of the run times of earlier jobs of the same class, a new class falling
+	back to the estimate. PREDICT_ESTIMATE predicts the estimate scaled by the
+	exponential average of run time over estimate, correcting for habitual
+	over- or under-estimation. A job with neither falls back to the average of
+	all jobs so far. A running job which outlives its prediction is predicted
+	to run as long again. Must be called before any job arrives.
+	@param mode the source of run times.
+	@param alpha the weight, in (0,1], of each new run time in the averages. Other values keep 0.5.
+ */
+void scheduler_set_prediction(predict_t mode, float alpha)
+{
+	PRED_M = mode;
+	if ( alpha > 0 && alpha <= 1 )
+		PRED_A = alpha;
+}//scheduler_set_prediction
+
+
+/**
+	Returns the mean absolute difference between the run time predicted for
+	each job at arrival and its true running time.
+	@return the average prediction error of all jobs scheduled, in time units.
+ */
+float scheduler_average_prediction_error()
+{
+	return (PRED_N == 0) ? 0.0f : (float)(PRED_ERR / PRED_N);
+}//scheduler_average_prediction_error
+
+
+/**
+	Returns the mean of predicted minus true running time; negative when run
+	times are underestimated.
+	@return the average signed prediction error of all jobs scheduled, in time units.
+ */
+float scheduler_prediction_bias()
+{
+	return (PRED_N == 0) ? 0.0f : (float)(PRED_BIAS / PRED_N);
+}//scheduler_prediction_bias
+
+int predict(int cls, int est)
+{
+	double p = 1;
+	if ( PRED_M == PREDICT_CLASS && cls >= 0 && cls < CLASS_N && CLASS_AVG[cls] >= 0 )
+		p = CLASS_AVG[cls];
+	else if ( est > 0 )
+		p = ( PRED_M == PREDICT_ESTIMATE ) ? est * EST_RATIO : est;
+	else if ( RUN_AVG >= 0 )
+		p = RUN_AVG;
+	return ( p < 1 ) ? 1 : (int)(p + 0.5);
+}//predict
+
+void inc_pred(int j)
+{
+	int i, r = JOB_RUN(j), cls = JOB(j)->cls;
+	double e = JOB(j)->pred_t - r;
+
+	PRED_N++;
+	PRED_ERR += ( e < 0 ) ? -e : e;
+	PRED_BIAS += e;
+
+	RUN_AVG = ( RUN_AVG < 0 ) ? r : PRED_A * r + (1 - PRED_A) * RUN_AVG;
+	if ( JOB(j)->user_est > 0 )
+		EST_RATIO = PRED_A * r / JOB(j)->user_est + (1 - PRED_A) * EST_RATIO;
+	if ( cls < 0 )
+		return;
+
+	if ( cls >= CLASS_N )
+	{
+		int cnt = ( CLASS_N > 0 ) ? CLASS_N : 16;
+		while ( cnt <= cls )
+			cnt *= 2;
+		CLASS_AVG = ( double* )realloc(CLASS_AVG, sizeof(double)*cnt);
+		for ( i=CLASS_N; i < cnt; i++ )
+			CLASS_AVG[i] = -1;
+		CLASS_N = cnt;
+	}//if - grow the class table
+	CLASS_AVG[cls] = ( CLASS_AVG[cls] < 0 ) ? r : PRED_A * r + (1 - PRED_A) * CLASS_AVG[cls];
+}//inc_pred
+
+long long pred_rem(int j)
+{
+	// Predicted work less the work done, the remaining work itself under PREDICT_ORACLE
+	return JOB_EST(j) - ((long long)JOB_RUN(j) * SPEED_UNIT - JOB_REM(j));
+}//pred_rem
+
+//	------------------------------------------------------------------------------------------
+//	Admission Control
+//	------------------------------------------------------------------------------------------
+
+//	Token bucket rate limiting the arrivals of one priority
+typedef struct _token_bucket_t_
+{
+	int pri;
+	double rate;			//	Tokens added per time unit
+	double burst;			//	Most tokens the bucket holds
+	double tokens;
+	int t;					//	Time tokens were last added
+} token_bucket_t;
+
+int QUEUE_MAX = 0;				//	Queue depth at which arrivals are refused, 0 for no limit
+int WAIT_MAX = -1;				//	Estimated wait above which arrivals are refused, -1 for no limit
+int WAIT_PRI = INT_MIN;			//	Most urgent priority the wait limit applies to
+admit_t ADMIT_M = ADMIT_REJECT;
+token_bucket_t* BUCKET = NULL;
+int BUCKET_N = 0;
+
+long long REJECT_N = 0;			//	Arrivals refused for good
+long long DEFER_N = 0;			//	Arrivals refused for now
+
+/**
+	Refuses arrivals while the queue already holds depth jobs, so a burst
+	cannot grow it without bound. Jobs preempted back into the queue are
+	already admitted and may take it past the limit.
+	@param depth the most jobs the queue admits, or 0 for no limit.
+ */
+void scheduler_set_queue_limit(int depth)
+{
+	QUEUE_MAX = ( depth > 0 ) ? depth : 0;
+	ADMIT_ON = 1;
+}//scheduler_set_queue_limit
+
+
+/**
+	Refuses arrivals of priority priority or less urgent whose estimated wait
+	exceeds wait time units. The wait is estimated as the queue depth times
+	the average run time of the jobs finished so far (the arrival's own run
+	time until one has), spread over the cores online at their speeds.
+	@param wait the longest estimated wait admitted, or -1 for no limit.
+	@param priority the most urgent priority the limit applies to; more urgent arrivals are spared.
+ */
+void scheduler_set_wait_limit(int wait, int priority)
+{
+	WAIT_MAX = ( wait >= 0 ) ? wait : -1;
+	WAIT_PRI = priority;
+	ADMIT_ON = 1;
+}//scheduler_set_wait_limit
+
+
+/**
+	Limits the arrival rate of one priority with a token bucket: each
+	arrival takes a token, tokens are added at rate per time unit up to
+	burst, and an arrival finding the bucket empty is refused. The bucket
+	starts full. Setting a priority again replaces its limit.
+	@param priority the priority whose arrivals are limited.
+	@param rate the long-run arrivals admitted per time unit, must be positive.
+	@param burst the most arrivals admitted back to back, at least 1.
+ */
+void scheduler_set_rate_limit(int priority, float rate, int burst)
+{
+	int i;
+	for ( i=0; i < BUCKET_N && BUCKET[i].pri != priority; i++ )
+		;
+	if ( i == BUCKET_N )
+	{
+		BUCKET = ( token_bucket_t* )realloc(BUCKET, sizeof(token_bucket_t)*(BUCKET_N + 1));
+		BUCKET_N++;
+	}//if - a new bucket
+	BUCKET[i].pri = priority;
+	BUCKET[i].rate = rate;
+	BUCKET[i].burst = ( burst > 1 ) ? burst : 1;
+	BUCKET[i].tokens = BUCKET[i].burst;
+	BUCKET[i].t = cur_t;
+	ADMIT_ON = 1;
+}//scheduler_set_rate_limit
+
+
+/**
+	Chooses what happens to an arrival the limits refuse. ADMIT_REJECT
+	drops it for good; the new job call returns JOB_REJECTED. ADMIT_DEFER
+	turns it away for now; the new job call returns JOB_DEFERRED and the
+	caller should offer the job again later under the same job number. The
+	job keeps its first arrival time, so time spent deferred counts as
+	waiting, and it faces the limits afresh each time it is offered.
+	@param mode ADMIT_REJECT (the default) or ADMIT_DEFER.
+ */
+void scheduler_set_admission(admit_t mode)
+{
+	ADMIT_M = mode;
+}//scheduler_set_admission
+
+int admit_job(int pr, int r)
+{
+	int i;
+	long long speed = 0;
+	if ( QUEUE_MAX > 0 && queue_size() >= QUEUE_MAX )
+		return 0;
+	if ( WAIT_MAX >= 0 && pr >= WAIT_PRI && queue_size() > 0 )
+	{
+		for ( i=0; i < cores.cnt; i++ )
+			speed += cores.speed[i];
+		if ( queue_size() * (( RUN_AVG >= 0 ) ? RUN_AVG : r) * SPEED_UNIT / speed > WAIT_MAX )
+			return 0;
+	}//if - estimated wait too long
+
+	// Only an arrival every other limit admits takes a token
+	for ( i=0; i < BUCKET_N && BUCKET[i].pri != pr; i++ )
+		;
+	if ( i < BUCKET_N )
+	{
+		BUCKET[i].tokens += BUCKET[i].rate * (cur_t - BUCKET[i].t);
+		if ( BUCKET[i].tokens > BUCKET[i].burst )
+			BUCKET[i].tokens = BUCKET[i].burst;
+		BUCKET[i].t = cur_t;
+		if ( BUCKET[i].tokens < 1 )
+			return 0;
+		BUCKET[i].tokens -= 1;
+	}//if
+	return 1;
+}//admit_job
+
+int refuse_job(int j, int a, int r, int pr)
+{
+	if ( ADMIT_M == ADMIT_DEFER )
+	{
+		DEFER_N++;
+		if ( !is_deferred(j) )
+		{
+			create_job(j, a, r, pr);
+			JOB(j)->deferred = 1;
+		}//if - hold the record, it remembers the first arrival
+		return JOB_DEFERRED;
+	}//if
+
+	REJECT_N++;
+	if ( is_deferred(j) )
+	{
+		JOB(j)->deferred = 0;
+		free_job(j);
+	}//if
+	else
+		spend_id(j);
+	return JOB_REJECTED;
+}//refuse_job
+
+int is_deferred(int j)
+{
+	return j >= 0 && (j >> JOB_SLAB_BITS) < job_tab.slabs && JOB_SLAB_OF(j) != NULL && JOB(j)->deferred;
+}//is_deferred
+
+//	------------------------------------------------------------------------------------------
+//	Fair Share
+//	------------------------------------------------------------------------------------------
+
+/**
+	Enables hierarchical fair share and sets the weight of one tenant.
+
+	Each tenant's jobs then wait in a queue of their own, ordered by the
+	scheme in effect. A freed core goes to the tenant with queued jobs which
+	has received the least work for its weight, much as CFS orders jobs by
+	virtual runtime; ties go to the lowest tenant. A tenant coming back from
+	idle starts level with the least served active tenant, so it cannot bank
+	credit while idle. A burst from one tenant thus queues behind its own
+	work rather than everyone's. Preemption still follows the scheme alone.
+	Tenants without a weight weigh 1. Must be called before any job arrives.
+	@param tenant the tenant, below TENANTS_MAX.
+	@param weight the tenant's share of the cores relative to the others, at least 1.
+ */
+void scheduler_set_tenant_weight(int tenant, int weight)
+{
+	if ( tenant >= TENANT_N )
+		grow_tenant(tenant + 1);
+	TENANT[tenant].weight = ( weight > 1 ) ? weight : 1;
+	FAIR = 1;
+}//scheduler_set_tenant_weight
+
+
+/**
+	Returns the number of tenants, one more than the highest tenant any job
+	or weight has named so far.
+	@return the number of tenants.
+ */
+int scheduler_tenant_count()
+{
+	return TENANT_N;
+}//scheduler_tenant_count
+
+
+/**
+	Fills in the figures kept for one tenant, with or without fair share: its
+	weight, the core time its jobs received and the distribution of their
+	turnaround times.
+	@param tenant the tenant, below scheduler_tenant_count().
+	@param stats where to store the figures.
+ */
+void scheduler_tenant_stats(int tenant, tenant_stats_t* stats)
+{
+	stats->weight = TENANT[tenant].weight;
+	stats->service = TENANT[tenant].cpu_t;
+	hist_stats(&TENANT[tenant].turn, &stats->turnaround);
+}//scheduler_tenant_stats
+
+void grow_tenant(int n)
+{
+	int i;
+	TENANT = ( tenant_t* )realloc(TENANT, sizeof(tenant_t)*n);
+	TENANT_ORD = ( int* )realloc(TENANT_ORD, sizeof(int)*n);
+	for ( i=TENANT_N; i < n; i++ )
+	{
+		TENANT[i].weight = 1;
+		TENANT[i].vserv = 0;
+		TENANT[i].q = make_queue(NULL);
+		TENANT[i].run = 0;
+		TENANT[i].cpu_t = 0;
+		histogram_init(&TENANT[i].turn);
+	}//for
+	TENANT_N = n;
+}//grow_tenant
+
+void fair_wake(int t)
+{
+	int i, found = 0;
+	long long v = 0;
+	if ( TENANT[t].run > 0 || priqueue_size(TENANT[t].q) > 0 )
+		return;
+
+	// Level with the least served tenant still active
+	for ( i=0; i < TENANT_N; i++ )
+	{
+		if ( i != t && (TENANT[i].run > 0 || priqueue_size(TENANT[i].q) > 0) && (!found || TENANT[i].vserv < v) )
+		{
+			v = TENANT[i].vserv;
+			found = 1;
+		}//if
+	}//for
+	if ( found && TENANT[t].vserv < v )
+		TENANT[t].vserv = v;
+}//fair_wake
+
+int fair_pick()
+{
+	int i, t = -1;
+	for ( i=0; i < TENANT_N; i++ )
+		if ( priqueue_size(TENANT[i].q) > 0 && (t == -1 || TENANT[i].vserv < TENANT[t].vserv) )
+			t = i;
+	return t;
+}//fair_pick
+
+int fair_order()
+{
+	int i, n = 0;
+	for ( i=0; i < TENANT_N; i++ )
+		if ( priqueue_size(TENANT[i].q) > 0 )
+			TENANT_ORD[n++] = i;
+	qsort(TENANT_ORD, n, sizeof(int), &tenant_cmp);
+	TENANT_ORD_N = n;
+	return n;
+}//fair_order
+
+int tenant_cmp(const void * p1, const void * p2)
+{
+	int t1 = *(const int*)p1, t2 = *(const int*)p2;
+	return (TENANT[t1].vserv == TENANT[t2].vserv) ? t1 - t2 : (TENANT[t1].vserv < TENANT[t2].vserv) ? -1 : 1;
+}
+
+//	------------------------------------------------------------------------------------------
+//	Timing Calculations
+//	------------------------------------------------------------------------------------------
+
+//	Per-metric histograms, indexed by metric_t, with exact 64-bit sums
+histogram_t LAT_H[3];
+
+void inc_wait(int t)	{ histogram_record(&LAT_H[METRIC_WAIT], t); }
+void inc_resp(int t)	{ histogram_record(&LAT_H[METRIC_RESP], t); }
+void inc_turn(int t)	{ histogram_record(&LAT_H[METRIC_TURN], t); }
+
+int LATE_N = 0;				//	Jobs which carried a deadline
+int MISS_N = 0;				//	Jobs which finished after their deadline
+long long LATE_T = 0;		//	Sum of tardiness over missed deadlines
+
+void inc_late(int t)	{ LATE_N ++; if ( t > 0 ) { MISS_N ++; LATE_T += t; } }
+
+long long BSLD_N = 0;		//	Jobs finished
+double BSLD_T = 0;			//	Sum of their bounded slowdowns
+
+void inc_bsld(int t, int r)	{ double b = (double)t / ((r > BSLD_TAU) ? r : BSLD_TAU); BSLD_N ++; BSLD_T += (b > 1.0) ? b : 1.0; }
+
+/**
+	Returns the number of jobs which finished after their deadline.
+	Jobs submitted without a deadline are never counted.
+	@return the number of missed deadlines.
+ */
+int scheduler_deadline_misses()
+{
+	return MISS_N;
+}//scheduler_deadline_misses
+
+
+/**
+	Returns the number of finished jobs which carried a deadline.
+	@return the number of jobs with a deadline.
+ */
+int scheduler_deadline_jobs()
+{
+	return LATE_N;
+}//scheduler_deadline_jobs
+
+
+/**
+	Returns the total tardiness, the sum over every job of the time by which
+	it finished past its deadline. Jobs that met their deadline contribute zero.
+	@return the total tardiness of all jobs scheduled.
+ */
+long long scheduler_total_tardiness()
+{
+	return LATE_T;
+}//scheduler_total_tardiness
+
+/**
+	Returns the average waiting time of all jobs scheduled by your scheduler.
+	Assumptions:
+		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+	@return the average waiting time of all jobs scheduled.
+ */
+float scheduler_average_waiting_time()
+{
+	return (float)histogram_mean(&LAT_H[METRIC_WAIT]);
+}//scheduler_average_waiting_time
+
+
+/**
+	Returns the average bounded slowdown of all jobs scheduled by your
+	scheduler: turnaround time over run time, with run times below BSLD_TAU
+	counted as BSLD_TAU so very short jobs do not dominate, and never below 1.
+	@return the average bounded slowdown of all jobs scheduled.
+ */
+float scheduler_average_bounded_slowdown()
+{
+	return (BSLD_N == 0) ? 0.0f : (float)(BSLD_T / BSLD_N);
+}//scheduler_average_bounded_slowdown
+
+
+/**
+	Returns the longest waiting time of any job scheduled by your scheduler.
+	@return the maximum waiting time observed.
+ */
+int scheduler_max_waiting_time()
+{
+	return LAT_H[METRIC_WAIT].max;
+}//scheduler_max_waiting_time
+
+
+/**
+	Fills in the distribution of one timing metric over all finished jobs:
+	count, min, max, p50, p90, p99, p99.9, mean and standard deviation.
+
+	Percentiles come from a log-linear histogram and are exact below 16
+	time units and within 6.25% above; min, max and mean are exact.
+	@param metric which timing metric to report.
+	@param stats where to store the results.
+ */
+void scheduler_latency_stats(metric_t metric, latency_t* stats)
+{
+	hist_stats(&LAT_H[metric], stats);
+}//scheduler_latency_stats
+
+void hist_stats(histogram_t* h, latency_t* stats)
+{
+	stats->n = h->n;
+	stats->min = h->min;
+	stats->max = h->max;
+	stats->p50 = histogram_percentile(h, 0.50);
+	stats->p90 = histogram_percentile(h, 0.90);
+	stats->p99 = histogram_percentile(h, 0.99);
+	stats->p999 = histogram_percentile(h, 0.999);
+	stats->mean = histogram_mean(h);
+	stats->stddev = histogram_stddev(h);
+}//hist_stats
+
+
+/**
+	Fills in the scheduler's instrumentation counters: context switches,
+	preemptions, quantum re-dispatches, queue comparisons, refused arrivals,
+	queue depth, and per-core busy and idle time. Cores count as idle only while online.
+
+	The per-core arrays belong to the scheduler and stay valid until
+	scheduler_clean_up() is called. Times are counted up to the most recent
+	scheduler call.
+	@param stats where to store the counters.
+ */
+void scheduler_get_stats(sched_stats_t* stats)
+{
+	int i;
+	long long busy = 0, idle = 0;
+	for ( i=0; i < cores.max; i++ )
+	{
+		busy += cores.busy[i];
+		idle += cores.idle[i];
+	}//for
+
+	stats->switches = SWITCH_N;
+	stats->preemptions = PREEMPT_N;
+	stats->redispatches = REDISPATCH_N;
+	stats->comparisons = queue_comps();
+	stats->migrations = MIGRATE_N;
+	stats->rejected = REJECT_N;
+	stats->deferrals = DEFER_N;
+	stats->max_depth = DEPTH_MAX;
+	stats->avg_depth = (STAT_T == 0) ? 0.0 : (double)DEPTH_T / STAT_T;
+	hist_stats(&DEPTH_H, &stats->depth);
+	stats->elapsed = STAT_T;
+	stats->cores = cores.max;
+	stats->busy = cores.busy;
+	stats->idle = cores.idle;
+	stats->utilization = (busy + idle == 0) ? 0.0 : (double)busy / (busy + idle);
+}//scheduler_get_stats
+
+
+/**
+	Returns the average turnaround time of all jobs scheduled by your scheduler.
+	Assumptions:
+		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+	@return the average turnaround time of all jobs scheduled.
+ */
+float scheduler_average_turnaround_time()
+{
+	return (float)histogram_mean(&LAT_H[METRIC_TURN]);
+}//scheduler_average_turnaround_time
+
+
+/**
+	Returns the average response time of all jobs scheduled by your scheduler.
+	Assumptions:
+		- This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+	@return the average response time of all jobs scheduled.
+ */
+float scheduler_average_response_time()
+{
+	return (float)histogram_mean(&LAT_H[METRIC_RESP]);
+}//scheduler_average_response_time
+
+
+/**
+	Free any memory associated with your scheduler.
+ 
+	Assumptions:
+	- This function will be the last function called in your library.
+*/
+void scheduler_clean_up()
+{
+	int i;
+	PROF_REPORT();
+	
+	// Queued and running jobs go with their slabs
+	for ( i=0; i < job_tab.slabs; i++ )
+		free(job_tab.slab[i]);
+	free(job_tab.slab);
+	free(CLASS_AVG);
+	free(BUCKET);
+	
+	priqueue_destroy(jobs);
+	free(jobs);
+	for ( i=0; i < TENANT_N; i++ )
+	{
+		priqueue_destroy(TENANT[i].q);
+		free(TENANT[i].q);
+	}//for
+	free(TENANT);
+	free(TENANT_ORD);
+	free(SHOW_L);
+	free_core(&cores);
+}//scheduler_clean_up
+
+
+/**
+	This function may print out any debugging information you choose. This
+	function will be called by the simulator after every call the simulator
+	makes to your scheduler.
+	In our provided output, we have implemented this function to list the jobs in the order they are to be scheduled. Furthermore, we have also listed the current state of the job (either running on a given core or idle). For example, if we have a non-preemptive algorithm and job(id=4) has began running, job(id=2) arrives with a higher priority, and job(id=1) arrives with a lower priority, the output in our sample output will be:
+		2(-1) 4(0) 1(-1)	
+
+	This function is not required and will not be graded. You may leave it
+	blank if you do not find it useful.
+ */
+void scheduler_show_queue()
+{
+	int i, k;
+
+	// From the first call on, jobs are added as they join the queue; start with the queue,
+	// then place the running jobs as if they had just arrived
+	if ( !SHOW_ON )
+	{
+		SHOW_ON = 1;
+		queue_for_each(&show_add,NULL);
+		for ( i=0; i < cores.cnt; i++ )
+			if ( cores.jobs[i] != -1 && show_core(cores.jobs[i]) == i )
+				show_offer(cores.jobs[i]);
+	}//if
+
+	// The queued jobs fill their places in queue order, which fair share reorders as it goes
+	k = 0;
+	queue_for_each(&show_job,&k);
+	for ( ; k < SHOW_N; k++ )
+		if ( JOB(SHOW_L[k])->updt_core_t != -1 )
+			printf("%d(%d) ", SHOW_L[k], show_core(SHOW_L[k]));
+}
+
+
+/**
+	Returns the number of jobs waiting in the queue, not counting the jobs
+	running on a core.
+	@return the current queue depth.
+ */
+int scheduler_queue_depth()
+{
+	return queue_size();
+}//scheduler_queue_depth
+
+//	------------------------------------------------------------------------------------------
+//	Checkpointing
+//	------------------------------------------------------------------------------------------
+
+#define SNAP_TAG		0x4C534809		//	"LSH" and the format version
+#define SNAP_PUT(v)		fwrite(&(v), sizeof(v), 1, f)
+#define SNAP_PUT_N(p,n)	((n) && fwrite((p), sizeof(*(p)), (n), f))
+#define SNAP_GET(v)		(ok = ok && fread(&(v), sizeof(v), 1, f) == 1)
+#define SNAP_GET_N(p,n)	(ok = ok && (!(n) || (int)fread((p), sizeof(*(p)), (n), f) == (n)))
+
+/**
+	Writes the scheduler's state to f: the queue, the jobs queued, running
+	and deferred, the core assignments and every statistic kept so far. Options
+	set through the scheduler_set_*() functions are not saved.
+	@param f a binary stream open for writing.
+	@return 1 on success, 0 if writing failed.
+ */
+int scheduler_save(FILE* f)
+{
+	int i, n, tag = SNAP_TAG;
+	long long comps = queue_comps();
+	SNAP_PUT(tag);
+	SNAP_PUT(cores.max);	SNAP_PUT(cores.cnt);
+	SNAP_PUT(sch_type);
+
+	SNAP_PUT(cur_t);		SNAP_PUT(STAT_T);		SNAP_PUT(GANG);
+	SNAP_PUT(PRI_LO);		SNAP_PUT(PRI_HI);
+	SNAP_PUT(CFS_LOAD);		SNAP_PUT(CFS_MIN_V);
+	SNAP_PUT(SWITCH_N);		SNAP_PUT(PREEMPT_N);	SNAP_PUT(REDISPATCH_N);		SNAP_PUT(MIGRATE_N);
+	SNAP_PUT(DEPTH_MAX);	SNAP_PUT(DEPTH_T);		SNAP_PUT(comps);
+	SNAP_PUT(DEPTH_H);
+	SNAP_PUT(REJECT_N);		SNAP_PUT(DEFER_N);
+	SNAP_PUT(LAT_H);
+	SNAP_PUT(LATE_N);		SNAP_PUT(MISS_N);		SNAP_PUT(LATE_T);
+	SNAP_PUT(BSLD_N);		SNAP_PUT(BSLD_T);
+	SNAP_PUT(PRED_N);		SNAP_PUT(PRED_ERR);		SNAP_PUT(PRED_BIAS);
+	SNAP_PUT(RUN_AVG);		SNAP_PUT(EST_RATIO);	SNAP_PUT(CLASS_N);
+	SNAP_PUT_N(CLASS_AVG, CLASS_N);
+	SNAP_PUT(SHOW_ON);		SNAP_PUT(SHOW_N);		SNAP_PUT_N(SHOW_L, SHOW_N);
+
+	SNAP_PUT(BUCKET_N);
+	for ( i=0; i < BUCKET_N; i++ )
+	{
+		SNAP_PUT(BUCKET[i].pri);	SNAP_PUT(BUCKET[i].tokens);	SNAP_PUT(BUCKET[i].t);
+	}//for
+
+	SNAP_PUT(TENANT_N);
+	for ( i=0; i < TENANT_N; i++ )
+	{
+		SNAP_PUT(TENANT[i].vserv);	SNAP_PUT(TENANT[i].cpu_t);	SNAP_PUT(TENANT[i].turn);
+	}//for
+
+	SNAP_PUT_N(cores.jobs, cores.max);
+	SNAP_PUT_N(cores.last, cores.max);
+	SNAP_PUT_N(cores.busy, cores.max);
+	SNAP_PUT_N(cores.idle, cores.max);
+
+	// Slab bookkeeping, so slabs are freed when they would have been
+	SNAP_PUT(job_tab.slabs);
+	for ( i=0; i < job_tab.slabs; i++ )
+	{
+		n = ( job_tab.slab[i] != NULL );
+		SNAP_PUT(n);
+		if ( n )
+		{
+			SNAP_PUT(job_tab.slab[i]->used);
+			SNAP_PUT(job_tab.slab[i]->live);
+		}//if
+	}//for
+	SNAP_PUT(job_tab.spent_slab);	SNAP_PUT(job_tab.spent);
+
+	// Running jobs, each gang once, then the queue in order
+	for ( i=0; i < cores.cnt; i++ )
+		if ( cores.jobs[i] != -1 && gang_lead(cores.jobs[i]) == i )
+			snap_job(JOB_REF(cores.jobs[i]), f);
+	n = -1;
+	SNAP_PUT(n);
+	n = queue_size();
+	SNAP_PUT(n);
+	queue_for_each(&snap_job,f);
+
+	// Deferred jobs live in the job table alone
+	for ( i=0; i < job_tab.slabs * JOB_SLAB; i++ )
+		if ( JOB_SLAB_OF(i) != NULL && JOB(i)->deferred )
+			snap_job(JOB_REF(i), f);
+	n = -1;
+	SNAP_PUT(n);
+
+	return !ferror(f);
+}//scheduler_save
+
+
+/**
+	Restores the state written by scheduler_save(), including which cores
+	were online. The scheduler must have been started with no more cores than
+	the state holds and be otherwise untouched apart from the
+	scheduler_set_*() options. The scheme may differ from the
+	one saved, to try another policy from a common starting point: the queue
+	is re-sorted under the scheme in effect.
+	@param f a binary stream open for reading, positioned where scheduler_save() began.
+	@return 1 on success, 0 if f does not hold a compatible state.
+ */
+int scheduler_restore(FILE* f)
+{
+	int i, n, s, tag = 0, max = 0, cnt = 0, ok = 1;
+	scheme_t saved = sch_type;
+	long long comps = 0;
+	SNAP_GET(tag);
+	SNAP_GET(max);		SNAP_GET(cnt);
+	SNAP_GET(saved);
+	if ( !ok || tag != SNAP_TAG || max < cores.max || cnt < 1 || cnt > max )
+		return 0;
+	if ( max > cores.max )
+		grow_core(&cores,max);
+	cores.cnt = cnt;
+
+	SNAP_GET(cur_t);		SNAP_GET(STAT_T);		SNAP_GET(n);		GANG |= n;
+	SNAP_GET(PRI_LO);		SNAP_GET(PRI_HI);
+	SNAP_GET(CFS_LOAD);		SNAP_GET(CFS_MIN_V);
+	SNAP_GET(SWITCH_N);		SNAP_GET(PREEMPT_N);	SNAP_GET(REDISPATCH_N);		SNAP_GET(MIGRATE_N);
+	SNAP_GET(DEPTH_MAX);	SNAP_GET(DEPTH_T);		SNAP_GET(comps);
+	SNAP_GET(DEPTH_H);
+	SNAP_GET(REJECT_N);		SNAP_GET(DEFER_N);
+	SNAP_GET(LAT_H);
+	SNAP_GET(LATE_N);		SNAP_GET(MISS_N);		SNAP_GET(LATE_T);
+	SNAP_GET(BSLD_N);		SNAP_GET(BSLD_T);
+	SNAP_GET(PRED_N);		SNAP_GET(PRED_ERR);		SNAP_GET(PRED_BIAS);
+	SNAP_GET(RUN_AVG);		SNAP_GET(EST_RATIO);	SNAP_GET(n);
+	if ( !ok || n < 0 )
+		return 0;
+	CLASS_AVG = ( double* )realloc(CLASS_AVG, sizeof(double)*(n + 1));
+	CLASS_N = n;
+	SNAP_GET_N(CLASS_AVG, CLASS_N);
+	SNAP_GET(SHOW_ON);		SNAP_GET(n);
+	if ( !ok || n < 0 )
+		return 0;
+	SHOW_L = ( int* )realloc(SHOW_L, sizeof(int)*(n + 1));
+	SHOW_N = SHOW_CAP = n;
+	SNAP_GET_N(SHOW_L, SHOW_N);
+
+	// Token counts carry over to the buckets still configured
+	SNAP_GET(n);
+	for ( i=0; ok && i < n; i++ )
+	{
+		token_bucket_t b;
+		SNAP_GET(b.pri);	SNAP_GET(b.tokens);		SNAP_GET(b.t);
+		for ( s=0; s < BUCKET_N; s++ )
+		{
+			if ( BUCKET[s].pri == b.pri )
+			{
+				BUCKET[s].tokens = ( b.tokens < BUCKET[s].burst ) ? b.tokens : BUCKET[s].burst;
+				BUCKET[s].t = b.t;
+			}//if
+		}//for
+	}//for
+
+	// Tenants before the jobs queued in them, weights stay as configured
+	SNAP_GET(n);
+	if ( !ok || n < 0 )
+		return 0;
+	if ( n > TENANT_N )
+		grow_tenant(n);
+	for ( i=0; ok && i < n; i++ )
+	{
+		SNAP_GET(TENANT[i].vserv);	SNAP_GET(TENANT[i].cpu_t);	SNAP_GET(TENANT[i].turn);
+	}//for
+
+	SNAP_GET_N(cores.jobs, cores.max);
+	SNAP_GET_N(cores.last, cores.max);
+	SNAP_GET_N(cores.busy, cores.max);
+	SNAP_GET_N(cores.idle, cores.max);
+
+	SNAP_GET(n);
+	if ( !ok || n < 0 )
+		return 0;
+	free(job_tab.slab);
+	job_tab.slab = ( job_slab_t** )calloc(n + 1, sizeof(job_slab_t*));
+	job_tab.slabs = n;
+	for ( i=0; i < n && ok; i++ )
+	{
+		SNAP_GET(s);
+		if ( ok && s )
+		{
+			job_tab.slab[i] = ( job_slab_t* )calloc(1, sizeof(job_slab_t));
+			SNAP_GET(job_tab.slab[i]->used);
+			SNAP_GET(job_tab.slab[i]->live);
+		}//if
+	}//for
+	SNAP_GET(job_tab.spent_slab);	SNAP_GET(job_tab.spent);
+
+	// Running jobs up to the -1, then the queue
+	while ( (i = unsnap_job(f)) >= 0 )
+		if ( JOB(i)->tenant >= TENANT_N )
+			return 0;
+	if ( i == -2 )
+		return 0;
+	SNAP_GET(n);
+	for ( s=0; ok && s < n; s++ )
+	{
+		i = unsnap_job(f);
+		if ( i < 0 || JOB(i)->tenant >= TENANT_N )
+			return 0;
+		queue_offer(i);
+	}//for
+	jobs->comps = comps;
+	for ( i=0; i < TENANT_N; i++ )
+		TENANT[i].q->comps = 0;
+	if ( !ok )
+		return 0;
+	while ( (i = unsnap_job(f)) >= 0 )
+		;
+	if ( i == -2 )
+		return 0;
+
+	// Scheme dependent state follows the scheme now in effect
+	if ( saved != sch_type )
+	{
+		CFS_LOAD = 0;
+		for ( i=0; i < cores.cnt && sch_type == CFS; i++ )
+			if ( cores.jobs[i] != -1 )
+				CFS_LOAD += JOB(cores.jobs[i])->wgt;
+		if ( sch_type == CFS )
+			queue_for_each(&cfs_load_job,NULL);
+	}//if
+	for ( i=0; i < cores.cnt; i++ )
+	{
+		cores.key[i] = ( cores.jobs[i] != -1 ) ? run_key(cores.jobs[i]) : LLONG_MIN;
+		if ( cores.jobs[i] != -1 )
+			TENANT[JOB(cores.jobs[i])->tenant].run++;
+	}//for
+	hetero_core();
+	return 1;
+}//scheduler_restore
+
+void snap_job(void * p, void * arg)
+{
+	FILE* f = ( FILE* )arg;
+	int j = JOB_ID(p);
+	SNAP_PUT(j);
+	SNAP_PUT(JOB_ARR(j));	SNAP_PUT(JOB_RUN(j));	SNAP_PUT(JOB_REM(j));	SNAP_PUT(JOB_PRI(j));
+	SNAP_PUT(JOB_DL(j));	SNAP_PUT(JOB_VRUN(j));	SNAP_PUT(JOB_EST(j));	SNAP_PUT(*JOB(j));
+}//snap_job
+
+int unsnap_job(FILE* f)
+{
+	int j = -2, ok = 1;
+	SNAP_GET(j);
+	if ( !ok || j < -1 || (j >= 0 && ((j >> JOB_SLAB_BITS) >= job_tab.slabs || JOB_SLAB_OF(j) == NULL)) )
+		return -2;
+	if ( j == -1 )
+		return -1;
+	SNAP_GET(JOB_ARR(j));	SNAP_GET(JOB_RUN(j));	SNAP_GET(JOB_REM(j));	SNAP_GET(JOB_PRI(j));
+	SNAP_GET(JOB_DL(j));	SNAP_GET(JOB_VRUN(j));	SNAP_GET(JOB_EST(j));	SNAP_GET(*JOB(j));
+	return ok ? j : -2;
+}//unsnap_job
+
+void cfs_load_job(void * p, void * arg) { CFS_LOAD += JOB(JOB_ID(p))->wgt; }
+
+//	------------------------------------------------------------------------------------------
+//	Custom Helper Functions
+//	------------------------------------------------------------------------------------------
+void	free_core	(core_t *p)			{ free(p->jobs); free(p->key); free(p->cand); free(p->due); free(p->start); free(p->last); free(p->busy); free(p->idle); free(p->speed); }
+int		is_prempt	()					{ return POLICY->should_preempt != NULL; }
+int		get_core	()					{	if ( cores.hetero ) { return corescan_fastest_idle(cores.jobs, cores.speed, cores.cnt); }
+											return corescan_first_idle(cores.jobs, cores.cnt);
+										}
+void	create_core	(core_t *p, int x)	{	memset(p, 0, sizeof(core_t));
+											p->cnt = x;
+											grow_core(p,x);
+										}
+void	hetero_core	()					{	int i;
+											cores.hetero = 0;
+											for ( i=1; i < cores.cnt; i++ )
+												if ( cores.speed[i] != cores.speed[0] )
+													cores.hetero = 1;
+										}
+void grow_core(core_t *p, int x)
+{
+	int i;
+	p->jobs = ( int* )realloc(p->jobs, sizeof(int)*x);
+	p->key = ( long long* )realloc(p->key, sizeof(long long)*x);
+	p->cand = ( int* )realloc(p->cand, sizeof(int)*x);
+	p->due = ( int* )realloc(p->due, sizeof(int)*x);
+	p->start = ( int* )realloc(p->start, sizeof(int)*x);
+	p->last = ( int* )realloc(p->last, sizeof(int)*x);
+	p->busy = ( long long* )realloc(p->busy, sizeof(long long)*x);
+	p->idle = ( long long* )realloc(p->idle, sizeof(long long)*x);
+	p->speed = ( int* )realloc(p->speed, sizeof(int)*x);
+	for ( i=p->max; i < x; i++ )
+	{
+		p->jobs[i] = -1;
+		p->key[i] = LLONG_MIN;
+		p->last[i] = -1;
+		p->busy[i] = 0;
+		p->idle[i] = 0;
+		p->speed[i] = SPEED_UNIT;
+	}//for
+	p->max = x;
+}
+
+int place_job(int job)
+{
+	int i;
+	show_offer(job);
+	if ( (i = get_core()) != -1 )
+	{
+		insert_job(i,job);
+		return i;
+	}//if
+	else if ( is_prempt() )
+	{
+		i = preempt(job);
+		if ( i == -1 )
+			queue_offer(job);
+		return i;
+	}//else if
+	queue_offer(job);
+	return -1;
+}
+
+job_slab_t* use_slab(int j)
+{
+	if ( j < 0 )
+	{
+		printf("Job creation failed, invalid job ID: %d", j);
+		exit(1);
+	}//if - job IDs index the job table
+
+	int n = (j >> JOB_SLAB_BITS) + 1;
+	if ( n > job_tab.slabs )
+	{
+		int cnt = ( job_tab.slabs > 0 ) ? job_tab.slabs : 1;
+		while ( cnt < n )
+			cnt *= 2;
+		job_tab.slab = ( job_slab_t** )realloc(job_tab.slab, sizeof(job_slab_t*)*cnt);
+		memset(job_tab.slab + job_tab.slabs, 0, sizeof(job_slab_t*)*(cnt - job_tab.slabs));
+		job_tab.slabs = cnt;
+	}//if - grow the slab directory
+	if ( JOB_SLAB_OF(j) == NULL )
+	{
+		JOB_SLAB_OF(j) = ( job_slab_t* )calloc(1, sizeof(job_slab_t));
+		if ( job_tab.spent_slab == n - 1 )
+		{
+			JOB_SLAB_OF(j)->used = job_tab.spent;
+			job_tab.spent = 0;
+		}//if - count the IDs refused before it was allocated
+	}//if
+	JOB_SLAB_OF(j)->used++;
+	return JOB_SLAB_OF(j);
+}
+
+void drop_slab(int j)
+{
+	job_slab_t* s = JOB_SLAB_OF(j);
+
+	// Job IDs are unique, so a slab whose every record has come and gone is done
+	if ( s->live == 0 && s->used >= JOB_SLAB )
+	{
+		free(s);
+		JOB_SLAB_OF(j) = NULL;
+	}//if
+}
+
+//	An ID refused without a record still counts towards freeing its slab, but never allocates
+//	one: IDs arrive in order, so only the latest slab not yet allocated may still be
+void spend_id(int j)
+{
+	int n = j >> JOB_SLAB_BITS;
+	if ( j < 0 )
+	{
+		printf("Job creation failed, invalid job ID: %d", j);
+		exit(1);
+	}//if - job IDs index the job table
+
+	if ( n < job_tab.slabs && job_tab.slab[n] != NULL )
+	{
+		job_tab.slab[n]->used++;
+		drop_slab(j);
+	}//if
+	else
+	{
+		if ( job_tab.spent_slab != n )
+			job_tab.spent = 0;
+		job_tab.spent_slab = n;
+		job_tab.spent++;
+	}//else
+}
+
+int create_job(int j, int a, int r, int pr)
+{
+	use_slab(j)->live++;
+
+	job_t* p = JOB(j);
+	JOB_ARR(j) = a;
+	JOB_RUN(j) = r;
+	JOB_REM(j) = (long long)r * SPEED_UNIT;
+	JOB_PRI(j) = pr;
+	JOB_DL(j) = -1;
+	JOB_VRUN(j) = 0;
+	JOB_EST(j) = (long long)r * SPEED_UNIT;
+	p->init_core_t = -1;
+	p->updt_core_t = -1;
+	p->stall_t = -1;
+	p->wgt = CFS_PRIO_TO_WGT[ (pr < -20) ? 0 : (pr > 19) ? 39 : pr + 20 ];
+	p->wait_t = a;
+	p->last_core = -1;
+	p->cpu_t = 0;
+	p->width = 1;
+	p->lead = -1;
+	p->cls = -1;
+	p->user_est = -1;
+	p->pred_t = r;
+	p->deferred = 0;
+	p->tenant = 0;
+	return j;
+}
+
+void free_job(int j)
+{
+	show_drop(j);
+	JOB_SLAB_OF(j)->live--;
+	drop_slab(j);
+}
+
+int insert_job(int x, int job)
+{
+	if ( cores.jobs[x] != -1 )
+	{
+		printf("Job insertion failed on core: %d", x);
+		exit(1);
+	}//if - core isn't empty
+
+	// A gang job stalls once, on its lead core, the first inserted
+	int lead = ( JOB(job)->updt_core_t == -1 );
+	if ( lead )
+	{
+		JOB(job)->stall_t = cur_t;
+		JOB(job)->lead = x;
+	}//if
+	if ( cores.last[x] != job )
+	{
+		SWITCH_N++;
+		if ( lead )
+			JOB(job)->stall_t += SWITCH_C;
+	}//if
+	if ( JOB(job)->last_core != -1 && JOB(job)->last_core != x )
+	{
+		MIGRATE_N++;
+		JOB(job)->stall_t += MIGRATE_C;
+	}//if
+	cores.last[x] = job;
+	JOB(job)->last_core = x;
+	TENANT[JOB(job)->tenant].run++;
+
+	cores.jobs[x] = job;
+	cores.key[x] = run_key(job);
+	JOB(job)->updt_core_t = cur_t;
+	return job;
+}//insert_job
+
+void show_job(void * p, void * arg)
+{
+	int* k = ( int* )arg;
+	for ( ; *k < SHOW_N && JOB(SHOW_L[*k])->updt_core_t != -1; (*k)++ )
+		printf("%d(%d) ", SHOW_L[*k], show_core(SHOW_L[*k]));
+	printf("%d(-1) ", JOB_ID(p));
+	(*k)++;
+}
+
+void show_add(void * p, void * arg)
+{
+	if ( SHOW_N == SHOW_CAP )
+	{
+		SHOW_CAP = ( SHOW_CAP > 0 ) ? 2 * SHOW_CAP : 16;
+		SHOW_L = ( int* )realloc(SHOW_L, sizeof(int)*SHOW_CAP);
+	}//if
+	SHOW_L[SHOW_N++] = JOB_ID(p);
+}
+
+//	A job keeps its place while it runs; one joining the queue goes ahead of the first job
+//	it sorts before, running or not
+void show_offer(int job)
+{
+	int i, k;
+	if ( !SHOW_ON )
+		return;
+	show_drop(job);
+	show_add(JOB_REF(job),NULL);
+	for ( i=0; i < SHOW_N - 1 && show_cmp(job, SHOW_L[i]) >= 0; i++ );
+	for ( k=SHOW_N - 1; k > i; k-- )
+		SHOW_L[k] = SHOW_L[k-1];
+	SHOW_L[i] = job;
+}
+
+void show_drop(int job)
+{
+	int i;
+	for ( i=0; SHOW_ON && i < SHOW_N; i++ )
+	{
+		if ( SHOW_L[i] == job )
+		{
+			memmove(SHOW_L + i, SHOW_L + i + 1, sizeof(int)*(--SHOW_N - i));
+			return;
+		}//if
+	}//for
+}
+
+int show_core(int job)
+{
+	return ( JOB(job)->width > 1 ) ? gang_lead(job) : JOB(job)->last_core;
+}
+
+//	Round robin ranks every job alike, SJF by the time a job has left
+int show_cmp(int j1, int j2)
+{
+	if ( sch_type == RR )
+		return 0;
+	if ( sch_type == SJF )
+		return psjf_cmp(j1, j2);
+	return POLICY->compare(j1, j2);
+}
+
+int pri_key(const void * p) { return JOB_PRI(JOB_ID(p)) - PRI_LO; }
+
+void build_queue()
+{
+	int i;
+	jobs = make_queue(jobs);
+	for ( i=0; i < TENANT_N; i++ )
+		TENANT[i].q = make_queue(TENANT[i].q);
+}//build_queue
+
+priqueue_t* make_queue(priqueue_t* old)
+{
+	void* p;
+	priqueue_t* q = (priqueue_t*)malloc(sizeof(priqueue_t));
+	long long range = (long long)PRI_HI - PRI_LO + 1;
+
+	// The policy names the cheapest backing store that still orders its jobs correctly
+	if ( POLICY->store == PQ_BUCKET && AGE_T == 0 && range > 0 && range <= PRI_BUCKETS_MAX )
+		priqueue_init_bucket(q,&sch_time,&pri_key,(int)range);
+	else if ( POLICY->store == PQ_RBTREE )
+		priqueue_init_rb(q,&sch_time);
+	else if ( POLICY->store == PQ_FIFO )
+		priqueue_init_fifo(q,&sch_time);
+	else
+		priqueue_init(q,&sch_time);
+
+	if ( old != NULL )
+	{
+		q->comps = old->comps;
+		while( (p = priqueue_poll(old)) != NULL )
+			priqueue_offer(q,p);
+		priqueue_destroy(old);
+		free(old);
+	}//if
+	return q;
+}//make_queue
+
+//	The job queue, under fair share a queue per tenant served least served first
+void queue_offer(int job)
+{
+	show_offer(job);
+	if ( FAIR )
+	{
+		priqueue_offer(TENANT[JOB(job)->tenant].q,JOB_REF(job));
+		FAIR_N++;
+	}//if
+	else
+		priqueue_offer(jobs,JOB_REF(job));
+
+	// Sampled here, a burst queued and dispatched within one call still counts
+	if ( queue_size() > DEPTH_MAX )
+		DEPTH_MAX = queue_size();
+}
+
+int queue_peek()
+{
+	if ( !FAIR )
+		return JOB_ID(priqueue_peek(jobs));
+	int t = fair_pick();
+	return ( t == -1 ) ? -1 : JOB_ID(priqueue_peek(TENANT[t].q));
+}
+
+int queue_poll()
+{
+	if ( !FAIR )
+		return JOB_ID(priqueue_poll(jobs));
+	int t = fair_pick();
+	if ( t == -1 )
+		return -1;
+	FAIR_N--;
+	return JOB_ID(priqueue_poll(TENANT[t].q));
+}
+
+void queue_walk()
+{
+	// Tenants in the order they would be served, fixed for the walk; one emptied on the way
+	// just holds no more jobs
+	if ( FAIR )
+		fair_order();
+}
+
+int queue_at(int i)
+{
+	int k, n = TENANT_ORD_N;
+	if ( !FAIR )
+		return JOB_ID(priqueue_at(jobs,i));
+
+	// Each tenant's jobs in queue order, see queue_walk()
+	for ( k=0; k < n && i >= priqueue_size(TENANT[TENANT_ORD[k]].q); k++ )
+		i -= priqueue_size(TENANT[TENANT_ORD[k]].q);
+	return ( k < n ) ? JOB_ID(priqueue_at(TENANT[TENANT_ORD[k]].q,i)) : -1;
+}
+
+int queue_remove_at(int i)
+{
+	int k, n = TENANT_ORD_N;
+	if ( !FAIR )
+		return JOB_ID(priqueue_remove_at(jobs,i));
+
+	for ( k=0; k < n && i >= priqueue_size(TENANT[TENANT_ORD[k]].q); k++ )
+		i -= priqueue_size(TENANT[TENANT_ORD[k]].q);
+	if ( k == n )
+		return -1;
+	FAIR_N--;
+	return JOB_ID(priqueue_remove_at(TENANT[TENANT_ORD[k]].q,i));
+}
+
+int queue_size()
+{
+	return FAIR ? FAIR_N : priqueue_size(jobs);
+}
+
+void queue_for_each(void(*fn)(void *, void *), void *arg)
+{
+	int k, n;
+	if ( !FAIR )
+	{
+		priqueue_for_each(jobs,fn,arg);
+		return;
+	}//if
+
+	n = fair_order();
+	for ( k=0; k < n; k++ )
+		priqueue_for_each(TENANT[TENANT_ORD[k]].q,fn,arg);
+}
+
+long long queue_comps()
+{
+	int i;
+	long long n = jobs->comps;
+	for ( i=0; i < TENANT_N; i++ )
+		n += TENANT[i].q->comps;
+	return n;
+}
+
+int next_job(int core, int skip)
+{
+	int i, n = queue_size();
+	if ( n > AFFINITY_W )
+		n = AFFINITY_W;
+
+	// Prefer a cache-warm job near the head over the head itself
+	queue_walk();
+	for ( i=0; i < n; i++ )
+	{
+		int p = queue_at(i);
+		if ( JOB(p)->last_core == core && p != skip )
+			return queue_remove_at(i);
+	}//for
+	return queue_poll();
+}//next_job
+
+int remove_job(int core, int id)
+{
+	if ( cores.jobs[core] != id )
+	{
+		printf("Delete job failed, invaild job ID");
+		exit(1);
+	}//if - attempt to remove invalid job from core
+
+	int job = cores.jobs[core];
+	JOB(job)->updt_core_t = -1;
+	TENANT[JOB(job)->tenant].run--;
+	cores.jobs[core] = -1;
+	cores.key[core] = LLONG_MIN;
+	return job;
+}//remove_job
+
+int delete_job(int core, int id)
+{
+	int job = remove_job(core,id);
+	JOB(job)->wait_t = cur_t;
+	queue_offer(job);
+	return job;
+}//delete_job
+
+int preempt(int job)
+{
+	int x = ( POLICY->pick_victim != NULL ) ? POLICY->pick_victim(job) : pick_victim(job);
+
+	// insert job into core list.
+	if ( x >= 0 )
+	{
+		PREEMPT_N++;
+		delete_job(x,cores.jobs[x]);
+		insert_job(x,job);
+	}//if
+
+	return x;
+}//preempt
+
+int pick_victim(int job)
+{
+	int out_n, out = 0;
+	int c, i, x = -1;
+
+	// Only cores running a job keyed above the new one can be outranked by it
+	long long key = ( POLICY->run_key != NULL ) ? POLICY->run_key(job) : LLONG_MIN;
+	int n = corescan_above(cores.key, cores.cnt, key, cores.cand);
+	for ( c=0; c < n; c++ )
+	{
+		i = cores.cand[c];
+		out_n = POLICY->should_preempt(job, cores.jobs[i]);
+		if ( out_n <= 0 )
+			continue;
+
+		// Fastest core first, then the most outranked job, then the latest arrival
+		if ( x != -1 && cores.speed[i] != cores.speed[x] )
+		{
+			if ( cores.speed[i] > cores.speed[x] )
+			{
+				out = out_n;
+				x = i;
+			}//if
+		}//if
+		else if ( out_n > out )
+		{
+			out = out_n;
+			x = i;
+		}//else if
+		else if ( out_n == out )
+		{
+			if ( JOB_ARR(cores.jobs[x]) < JOB_ARR(cores.jobs[i]) )
+				x = i;
+		}//else if
+	}//for
+	return x;
+}//pick_victim
+
+long long run_key(int j)
+{
+	// A new job can only outrank a running job keyed strictly above it; on equal keys the
+	// arrival tie-break favours the running job, which arrived no later
+	return ( POLICY->run_key != NULL ) ? POLICY->run_key(j) : 0;
+}
+
+int sch_time(const void * p1, const void * p2)
+{
+	return POLICY->compare(JOB_ID(p1), JOB_ID(p2));
+}
+
+//	------------------------------------------------------------------------------------------
+//	Built-in Policies
+//	------------------------------------------------------------------------------------------
+static const policy_t BUILTIN[] =
+{
+	//	name	compare		should_preempt	on_quantum	pick_victim	run_key		store
+	{ "fcfs",	&fcfs_cmp,	NULL,			NULL,		NULL,		NULL,		PQ_FIFO },
+	{ "sjf",	&sjf_cmp,	NULL,			NULL,		NULL,		NULL,		PQ_LIST },
+	{ "psjf",	&psjf_cmp,	&psjf_outrank,	NULL,		NULL,		&rem_key,	PQ_LIST },
+	{ "pri",	&pri_cmp,	NULL,			NULL,		NULL,		&prio_key,	PQ_BUCKET },
+	{ "ppri",	&pri_cmp,	&pri_outrank,	NULL,		NULL,		&prio_key,	PQ_BUCKET },
+	{ "rr",		&rr_cmp,	NULL,			&rr_slice,	NULL,		NULL,		PQ_FIFO },
+	{ "cfs",	&cfs_cmp,	NULL,			&cfs_slice,	NULL,		NULL,		PQ_RBTREE },
+	{ "edf",	&edf_cmp,	NULL,			NULL,		NULL,		&dl_key,	PQ_LIST },
+	{ "pedf",	&edf_cmp,	&edf_outrank,	NULL,		NULL,		&dl_key,	PQ_LIST },
+	{ "easy",	&fcfs_cmp,	NULL,			NULL,		NULL,		NULL,		PQ_FIFO },
+};
+
+/**
+	Returns the built-in policy behind a scheme.
+	@param scheme any scheme but PLUGIN.
+	@return the policy, which lives as long as the program.
+ */
+const policy_t* scheduler_builtin_policy(scheme_t scheme)
+{
+	if ( scheme < FCFS || scheme >= PLUGIN )
+	{
+		printf("Scheduler start up failed, scheme %d has no built-in policy", scheme);
+		exit(1);
+	}//if
+	return &BUILTIN[scheme];
+}//scheduler_builtin_policy
+
+int fcfs_cmp(int j1, int j2) { return (int)(JOB_ARR(j1) - JOB_ARR(j2)); }
+
+//	Every job ranks alike, a requeued job goes to the back
+int rr_cmp(int j1, int j2) { return 0; }
+
+int sjf_cmp(int j1, int j2)
+{
+	return (JOB_EST(j1) == JOB_EST(j2)) ? fcfs_cmp(j1, j2) : (JOB_EST(j1) < JOB_EST(j2)) ? -1 : 1;
+}
+
+int psjf_cmp(int j1, int j2)
+{
+	// Keep the magnitude, pick_victim() picks the most outranked victim by it
+	long long r1 = pred_rem(j1), r2 = pred_rem(j2);
+	long long d = (r1 - r2) / SPEED_UNIT;
+	if ( d == 0 )
+		return (r1 == r2) ? fcfs_cmp(j1, j2) : (r1 < r2) ? -1 : 1;
+	return (d > INT_MAX) ? INT_MAX : (d < -INT_MAX) ? -INT_MAX : (int)d;
+}
+
+int pri_cmp(int j1, int j2)
+{
+	if ( AGE_T > 0 )
+	{
+		long long k1 = (long long)JOB_PRI(j1) * AGE_T + ( (JOB(j1)->updt_core_t == -1) ? JOB(j1)->wait_t : cur_t );
+		long long k2 = (long long)JOB_PRI(j2) * AGE_T + ( (JOB(j2)->updt_core_t == -1) ? JOB(j2)->wait_t : cur_t );
+		return (k1 == k2) ? fcfs_cmp(j1, j2) : (k1 < k2) ? -1 : 1;
+	}//if - aged priority
+	return ((int)(JOB_PRI(j1) - JOB_PRI(j2)) == 0) ? fcfs_cmp(j1, j2) : (int)(JOB_PRI(j1) - JOB_PRI(j2));
+}
+
+int cfs_cmp(int j1, int j2)
+{
+	return (JOB_VRUN(j1) == JOB_VRUN(j2)) ? fcfs_cmp(j1, j2) : (JOB_VRUN(j1) < JOB_VRUN(j2)) ? -1 : 1;
+}
+
+int edf_cmp(int j1, int j2)
+{
+	// Jobs without a deadline sort after every job that has one
+	unsigned int d1 = (unsigned int)JOB_DL(j1);
+	unsigned int d2 = (unsigned int)JOB_DL(j2);
+	return (d1 == d2) ? fcfs_cmp(j1, j2) : (d1 < d2) ? -1 : 1;
+}
+
+//	Preemptive schemes displace a running job the arrival sorts before
+int psjf_outrank(int job, int running)	{ int c = psjf_cmp(job, running); return ( c < 0 ) ? -c : 0; }
+int pri_outrank(int job, int running)	{ int c = pri_cmp(job, running); return ( c < 0 ) ? -c : 0; }
+int edf_outrank(int job, int running)	{ int c = edf_cmp(job, running); return ( c < 0 ) ? -c : 0; }
+
+long long rem_key(int j)	{ return pred_rem(j); }
+long long prio_key(int j)	{ return JOB_PRI(j); }
+long long dl_key(int j)		{ return (unsigned int)JOB_DL(j); }
+
+void inc_time(int t)
+{
+	int i;
+	cur_t = t;
+
+	// Account the interval since the previous call, during which nothing changed
+	if ( jobs != NULL )
+	{
+		int depth = queue_size();
+		DEPTH_T += (long long)depth * (cur_t - STAT_T);
+		histogram_record_n(&DEPTH_H, depth, cur_t - STAT_T);
+	}//if
+	for ( i=0; i < cores.cnt; i++ )
+	{
+		if ( cores.jobs[i] != -1 )
+			cores.busy[i] += cur_t - STAT_T;
+		else
+			cores.idle[i] += cur_t - STAT_T;
+	}//for
+	STAT_T = cur_t;
+
+	for ( i=0 ;i < cores.cnt; i++ )
+	{
+		// Catch temp job
+		int j = cores.jobs[i];
+		if ( j != -1 )	
+		{
+			job_t* job = JOB(j);
+
+			// if jobs is idle and not recently updated, get it scheduled and update response time
+			if ( (job->init_core_t == -1) && (job->updt_core_t != cur_t) )
+			{
+				job->init_core_t = job->updt_core_t;
+				inc_resp(job->init_core_t - JOB_ARR(j));
+			}//if
+
+			// Update remaining times for running jobs, which retire no work while stalled
+			int run_t = cur_t - ( ( job->stall_t > job->updt_core_t ) ? job->stall_t : job->updt_core_t );
+			if ( run_t > 0 )
+			{
+				JOB_REM(j) -= (long long)run_t * cores.speed[i];
+				job->cpu_t += run_t;
+			}//if
+
+			// A gang job is advanced once, on its lowest core, for all the cores it holds
+			tenant_t* t = &TENANT[job->tenant];
+			t->cpu_t += (long long)(cur_t - job->updt_core_t) * job->width;
+			t->vserv += (long long)(cur_t - job->updt_core_t) * job->width * cores.speed[i] / t->weight;
+			if ( sch_type == CFS )
+				JOB_VRUN(j) += (long long)(cur_t - job->updt_core_t) * CFS_NICE_0_LOAD * CFS_NICE_0_LOAD / job->wgt;
+			job->updt_core_t = cur_t;
+
+			// A job which outlives its prediction is expected to run as long again
+			if ( PRED_M != PREDICT_ORACLE && pred_rem(j) <= 0 )
+				JOB_EST(j) = 2 * ((long long)JOB_RUN(j) * SPEED_UNIT - JOB_REM(j));
+			cores.key[i] = run_key(j);
 		}//if
 	}//for
 }//inc_time
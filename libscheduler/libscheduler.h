@@ -3,48 +3,256 @@
 
 #ifndef LIBSCHEDULER_H_
 #define LIBSCHEDULER_H_
+#include <stdio.h>
+#include <stdint.h>
 #include "../libpriqueue/libpriqueue.h"
+#include "../libhistogram/libhistogram.h"
+#include "../libcorescan/libcorescan.h"
 
 //	------------------------------------------------------------------------------------------
 //	Stores information making up a job to be scheduled including any statistics.
 //	You may need to define some global variables or a struct to store your job queue elements. 
+//	The ordering keys live in the job table's key arrays, see JOB_REM() and friends.
 //	------------------------------------------------------------------------------------------
 typedef struct _job_t_
 {
-	int arr_t;			//	Job arrival time
-	int run_t;			//	Job run time
-	int rem_t;			//	Job time remaining
-	
-	int pri;			//	Job Priority 
-	int jid;			//	Job ID
-
 	int init_core_t;	//	Initial Core time
 	int updt_core_t;	//	Last updated cores time
+	int stall_t;		//	Time its switch or migration stall ends, see scheduler_set_switch_cost()
+
+	int wgt;			//	CFS load weight, derived from pri
+
+	int wait_t;			//	Time the job last entered the queue
+	int last_core;		//	Core the job last ran on, -1 if never dispatched
+	int cpu_t;			//	Time spent on a core so far
+	int width;			//	Cores the job runs on at once
+	int lead;			//	Core the job was first inserted on, its lowest under gang scheduling
+
+	int cls;			//	Job class, whose history predicts its run time
+	int user_est;		//	Run time estimate given at arrival, -1 if none
+	int pred_t;			//	Run time predicted at arrival
+
+	int deferred;		//	Set while admission control holds the job back
+	int tenant;			//	Tenant the job belongs to, 0 if none
 } job_t;
 
+//	------------------------------------------------------------------------------------------
+//	Job table. Jobs are indexed by job ID and allocated JOB_SLAB at a time; within a slab
+//	every key a comparator reads sits in its own contiguous array, apart from the
+//	job records, so a queue walk touches few cache lines and an arrival rarely mallocs.
+//	------------------------------------------------------------------------------------------
+#define JOB_SLAB_BITS	10
+#define JOB_SLAB		(1 << JOB_SLAB_BITS)
+
+typedef struct _job_slab_t_
+{
+	int arr_t[JOB_SLAB];			//	Job arrival time
+	int run_t[JOB_SLAB];			//	Job run time
+	long long rem_t[JOB_SLAB];		//	Job work remaining, in 1/SPEED_UNIT time units
+	int pri[JOB_SLAB];				//	Job Priority
+	int dl_t[JOB_SLAB];				//	Absolute deadline, -1 if none
+	long long vrun_t[JOB_SLAB];		//	CFS weighted virtual runtime
+	long long est_t[JOB_SLAB];		//	Predicted total work, in 1/SPEED_UNIT time units
+	job_t rec[JOB_SLAB];			//	Everything else
+
+	int used;						//	Records handed out so far
+	int live;						//	Records handed out and not yet freed
+} job_slab_t;
+
+typedef struct _job_table_t_
+{
+	job_slab_t** slab;				//	Slab directory, NULL where no slab is allocated
+	int slabs;
+	int spent_slab;					//	Slab not yet allocated that IDs were refused from, see spend_id()
+	int spent;						//	IDs refused from it
+} job_table_t;
+
+#define JOB_SLAB_OF(j)	(job_tab.slab[(j) >> JOB_SLAB_BITS])
+#define JOB_OFF(j)		((j) & (JOB_SLAB - 1))
+#define JOB(j)			(&JOB_SLAB_OF(j)->rec[JOB_OFF(j)])
+#define JOB_ARR(j)		(JOB_SLAB_OF(j)->arr_t[JOB_OFF(j)])
+#define JOB_RUN(j)		(JOB_SLAB_OF(j)->run_t[JOB_OFF(j)])
+#define JOB_REM(j)		(JOB_SLAB_OF(j)->rem_t[JOB_OFF(j)])
+#define JOB_PRI(j)		(JOB_SLAB_OF(j)->pri[JOB_OFF(j)])
+#define JOB_DL(j)		(JOB_SLAB_OF(j)->dl_t[JOB_OFF(j)])
+#define JOB_VRUN(j)		(JOB_SLAB_OF(j)->vrun_t[JOB_OFF(j)])
+#define JOB_EST(j)		(JOB_SLAB_OF(j)->est_t[JOB_OFF(j)])
+
+//	Queue entries carry job IDs rather than pointers, offset by one so job 0 is not NULL
+#define JOB_REF(j)		((void*)(intptr_t)((j) + 1))
+#define JOB_ID(p)		((int)(intptr_t)(p) - 1)
+
 //	------------------------------------------------------------------------------------------
 //	Useful global cores structure
 //	------------------------------------------------------------------------------------------
 typedef struct _core_t_
 {
-	job_t** jobs;
-	int cnt;
+	int* jobs;			//	Job ID running on each core, -1 if idle
+	int cnt;			//	Cores online, always the lowest numbered ones
+	int max;			//	Cores the arrays hold, online or not
+
+	long long* key;		//	run_key() of the job on each core, LLONG_MIN if idle
+	int* cand;			//	Scratch list of the cores preempt() and gang_fill() consider
+	int* due;			//	Time the gang led from each core finishes, see gang_fill()
+	int* start;			//	Jobs started by the latest call under gang scheduling
+	int start_n;
+
+	int* last;			//	Job ID each core ran most recently, -1 if none
+	long long* busy;	//	Time units each core spent running a job
+	long long* idle;	//	Time units each core spent idle
+	int* speed;			//	Work retired per time unit, in 1/SPEED_UNIT time units
+	int hetero;			//	Set once any two cores differ in speed
 } core_t;
 
+//	Fixed-point scale of core speeds and remaining work, a nominal core is SPEED_UNIT
+#define SPEED_UNIT	1000
+
+//	Widest priority range given a bucket per priority under PRI and PPRI
+#define PRI_BUCKETS_MAX	4096
+
+//	Most tenants jobs may belong to, see scheduler_new_job_tenant()
+#define TENANTS_MAX	4096
+
+//	Run time below which bounded slowdown treats a job as this long
+#define BSLD_TAU	10
+
+//	Returned for an arrival admission control refused, see scheduler_set_admission()
+#define JOB_REJECTED	-2
+#define JOB_DEFERRED	-3
+
+//
+//	Constants which represent the different scheduling algorithms, PLUGIN runs a policy_t of the caller's
+//
+typedef enum {FCFS = 0, SJF, PSJF, PRI, PPRI, RR, CFS, EDF, PEDF, EASY, PLUGIN} scheme_t;
+
+//	------------------------------------------------------------------------------------------
+//	Scheduling policy. Each scheme is a built-in policy, see scheduler_builtin_policy(), and
+//	scheduler_start_up_policy() runs any other. Callbacks take job IDs, read through JOB_ARR()
+//	and friends; a shared object exports one as PLUGIN_SYMBOL, a plugin_fn.
+//	------------------------------------------------------------------------------------------
+typedef struct _policy_t_
+{
+	const char* name;
+	int (*compare)(int j1, int j2);				//	Queue order, negative if j1 goes first
+	int (*should_preempt)(int job, int running);//	How far an arrival outranks a running job, 0 if not; NULL never preempts
+	int (*on_quantum)(int core_id, int job);	//	Timeslice of a dispatched job, -1 for the caller's quantum; NULL never slices
+	int (*pick_victim)(int job);				//	Core an arrival preempts, -1 if none; NULL takes the fastest, most outranked
+	long long (*run_key)(int job);				//	Optional, only running jobs keyed above an arrival are offered to should_preempt()
+	pq_type_t store;							//	Job queue backing store, PQ_BUCKET orders by priority then arrival only
+} policy_t;
+
+#define PLUGIN_SYMBOL	"scheduler_plugin"
+typedef const policy_t* (*plugin_fn)();
+
+//
+//	Sources of the run time SJF, PSJF and EASY order jobs by, see scheduler_set_prediction()
 //
-//	Constants which represent the different scheduling algorithms
+typedef enum {PREDICT_ORACLE = 0, PREDICT_CLASS, PREDICT_ESTIMATE} predict_t;
+
+//
+//	What admission control does with an arrival it refuses, see scheduler_set_admission()
+//
+typedef enum {ADMIT_REJECT = 0, ADMIT_DEFER} admit_t;
+
+//
+//	Timing metrics which keep a full distribution
+//
+typedef enum {METRIC_WAIT = 0, METRIC_RESP, METRIC_TURN} metric_t;
+
 //
-typedef enum {FCFS = 0, SJF, PSJF, PRI, PPRI, RR} scheme_t;
+//	Distribution summary of one timing metric
+//
+typedef struct _latency_t_
+{
+	long long n;
+	int min, max;
+	int p50, p90, p99, p999;
+	double mean, stddev;
+} latency_t;
+
+//
+//	Scheduler instrumentation counters, see scheduler_get_stats()
+//
+typedef struct _sched_stats_t_
+{
+	long long switches;			//	Dispatches of a job other than the one the core last ran
+	long long preemptions;		//	Running jobs displaced by a more urgent one
+	long long redispatches;		//	Quantum expirations which picked the same job again
+	long long comparisons;		//	Comparator calls made by the job queue
+	long long migrations;		//	Dispatches of a job onto a core other than its last one
+	long long rejected;			//	Arrivals admission control turned away for good
+	long long deferrals;		//	Arrivals admission control told to come back later
+
+	int max_depth;				//	Deepest the job queue has been, counting jobs queued and taken in one call
+	double avg_depth;			//	Time-weighted mean job queue depth
+	latency_t depth;			//	Job queue depth over time, one sample per time unit
+
+	int elapsed;				//	Time covered by the counters below
+	int cores;					//	Cores online at any point, or announced
+	const long long* busy;		//	Per-core busy time, cores entries
+	const long long* idle;		//	Per-core idle time, cores entries
+	double utilization;			//	Busy time over busy and idle time
+} sched_stats_t;
+
+//
+//	Figures kept per tenant, see scheduler_tenant_stats()
+//
+typedef struct _tenant_stats_t_
+{
+	int weight;					//	Share of the cores relative to other tenants, under fair share
+	long long service;			//	Time units the tenant's jobs spent on a core
+	latency_t turnaround;		//	Turnaround times of the tenant's finished jobs
+} tenant_stats_t;
 
 void	scheduler_start_up					(int cores_n, scheme_t scheme);
+void	scheduler_start_up_policy			(int cores_n, const policy_t* policy);
+const policy_t*	scheduler_builtin_policy	(scheme_t scheme);
 int		scheduler_new_job					(int job_number, int time, int running_time, int priority);
+int		scheduler_new_job_deadline			(int job_number, int time, int running_time, int priority, int deadline);
+int		scheduler_new_job_gang				(int job_number, int time, int running_time, int priority, int deadline, int width);
+int		scheduler_new_job_estimate			(int job_number, int time, int running_time, int priority, int deadline, int width,
+											 int job_class, int estimate);
+int		scheduler_new_job_tenant			(int job_number, int time, int running_time, int priority, int deadline, int width,
+											 int job_class, int estimate, int tenant);
+int		scheduler_job_cores					(int job_number, int* core_ids);
+int		scheduler_started_jobs				(int* job_numbers);
 int		scheduler_job_finished				(int core_id, int job_number, int time);
 int		scheduler_quantum_expired			(int core_id, int time);
 float	scheduler_average_turnaround_time	();
 float	scheduler_average_waiting_time		();
 float	scheduler_average_response_time		();
+float	scheduler_average_bounded_slowdown	();
+float	scheduler_average_prediction_error	();
+float	scheduler_prediction_bias			();
+int		scheduler_max_waiting_time			();
+void	scheduler_latency_stats				(metric_t metric, latency_t* stats);
+void	scheduler_get_stats					(sched_stats_t* stats);
+int		scheduler_deadline_misses			();
+int		scheduler_deadline_jobs				();
+long long	scheduler_total_tardiness		();
 void	scheduler_clean_up					();
 void	scheduler_show_queue				();
+int		scheduler_queue_depth				();
+void	scheduler_set_latency				(int latency);
+void	scheduler_set_aging					(int age);
+void	scheduler_set_affinity				(int window);
+void	scheduler_set_switch_cost			(int switch_cost, int migrate_cost);
+void	scheduler_set_priority_range		(int lo, int hi);
+void	scheduler_set_core_speed			(int core_id, float speed);
+void	scheduler_set_prediction			(predict_t mode, float alpha);
+void	scheduler_set_max_cores				(int cores_n);
+int		scheduler_core_online				(int time);
+int		scheduler_core_offline				(int time);
+void	scheduler_set_queue_limit			(int depth);
+void	scheduler_set_wait_limit			(int wait, int priority);
+void	scheduler_set_rate_limit			(int priority, float rate, int burst);
+void	scheduler_set_admission				(admit_t mode);
+void	scheduler_set_tenant_weight			(int tenant, int weight);
+int		scheduler_tenant_count				();
+void	scheduler_tenant_stats				(int tenant, tenant_stats_t* stats);
+int		scheduler_save						(FILE* f);
+int		scheduler_restore					(FILE* f);
+int		scheduler_time_slice				(int core_id);
 
 //	------------------------------------------------------------------------------------------
 //	Custom Helper Functions
@@ -52,25 +260,94 @@ void	scheduler_show_queue				();
 void	inc_wait	(int t);
 void	inc_resp	(int t);
 void	inc_turn	(int t);
+void	inc_late	(int t);
+void	inc_bsld	(int t, int r);
+void	inc_pred	(int j);
+int		predict		(int cls, int est);
 void	create_core	(core_t *p, int x);
+void	grow_core	(core_t *p, int x);
+int		place_job	(int job);
+void	hetero_core	();
+int		admit_job	(int pr, int r);
+int		refuse_job	(int j, int a, int r, int pr);
+int		is_deferred	(int j);
+void	grow_tenant	(int n);
+void	fair_wake	(int t);
+int		fair_pick	();
+int		fair_order	();
+int		tenant_cmp	(const void * p1, const void * p2);
 void	free_core	(core_t *p);
-void	free_job	(job_t* p);
+void	free_job	(int j);
 void	inc_time	(int t);
 int		get_core	();
 int		is_prempt	();
-int		preempt		(job_t* job);
+int		preempt		(int job);
+int		pick_victim	(int job);
+long long	run_key	(int j);
+int		fcfs_cmp	(int j1, int j2);
+int		rr_cmp		(int j1, int j2);
+int		sjf_cmp		(int j1, int j2);
+int		psjf_cmp	(int j1, int j2);
+int		pri_cmp		(int j1, int j2);
+int		cfs_cmp		(int j1, int j2);
+int		edf_cmp		(int j1, int j2);
+int		psjf_outrank	(int job, int running);
+int		pri_outrank	(int job, int running);
+int		edf_outrank	(int job, int running);
+int		rr_slice	(int core_id, int job);
+int		cfs_slice	(int core_id, int job);
+long long	rem_key	(int j);
+long long	prio_key	(int j);
+long long	dl_key	(int j);
+long long	pred_rem	(int j);
+void	snap_job	(void * p, void * arg);
+int		unsnap_job	(FILE* f);
+void	cfs_load_job	(void * p, void * arg);
 int		sch_time	(const void * p1, const void * p2);
-job_t*	create_job	(int j, int a, int r, int pr);
-job_t*	insert_job	(int x, job_t* job);
-job_t*	delete_job	(int core, int id);
+job_slab_t*	use_slab	(int j);
+void	drop_slab	(int j);
+void	spend_id	(int j);
+int		create_job	(int j, int a, int r, int pr);
+int		insert_job	(int x, int job);
+int		next_job	(int core, int skip);
+int		pri_key		(const void * p);
+void	show_job	(void * p, void * arg);
+void	show_add	(void * p, void * arg);
+void	show_offer	(int job);
+void	show_drop	(int job);
+int		show_core	(int job);
+int		show_cmp	(int j1, int j2);
+void	build_queue	();
+priqueue_t*	make_queue	(priqueue_t* old);
+void	queue_offer	(int job);
+int		queue_peek	();
+int		queue_poll	();
+void	queue_walk	();
+int		queue_at	(int i);
+int		queue_remove_at	(int i);
+int		queue_size	();
+void	queue_for_each	(void(*fn)(void *, void *), void *arg);
+long long	queue_comps	();
+void	hist_stats	(histogram_t* h, latency_t* stats);
+int		remove_job	(int core, int id);
+int		delete_job	(int core, int id);
+void	cfs_update_min	();
+int		gang_idle	();
+int		gang_lead	(int job);
+void	gang_start	(int job);
+void	gang_fill	();
+int		gang_slowest	(int first, int w);
+int		due_cmp		(const void * p1, const void * p2);
 
 
 //	------------------------------------------------------------------------------------------
 //	Global Var/Struct Initializations
 //	------------------------------------------------------------------------------------------
-priqueue_t* jobs;
-scheme_t sch_type;
-core_t cores;
-int cur_t;
+extern priqueue_t* jobs;
+extern scheme_t sch_type;
+extern const policy_t* POLICY;
+extern core_t cores;
+extern job_table_t job_tab;
+extern int cur_t;
 
 #endif /* LIBSCHEDULER_H_ */
@@ -0,0 +1,231 @@
+/** @file libtelemetry.c
+ */
+
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libtelemetry.h"
+
+
+//	------------------------------------------------------------------------------------------
+//	Writer
+//	------------------------------------------------------------------------------------------
+/**
+	Creates the shared memory segment name, replacing any left by an earlier run.
+
+	@param name a POSIX shared memory name, eg. "/scheduler"
+	@param cores the most cores the simulation may bring online
+	@return the ring, mapped for writing
+	@return NULL if the segment could not be created
+ */
+tel_ring_t* telemetry_create(const char *name, int cores)
+{
+	tel_ring_t *r;
+	int fd;
+
+	shm_unlink(name);
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd == -1)
+		return NULL;
+	if (ftruncate(fd, sizeof(tel_ring_t)) == -1)
+	{
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	r = (tel_ring_t*) mmap(NULL, sizeof(tel_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (r == MAP_FAILED)
+	{
+		shm_unlink(name);
+		return NULL;
+	}
+
+	// A fresh segment reads as zeroes, which is an empty ring
+	r->cores = cores;
+	r->pid = getpid();
+	atomic_thread_fence(memory_order_release);
+	r->magic = TEL_MAGIC;
+	return r;
+}
+
+
+/**
+	Publishes one event. Never blocks: the slot written is the oldest one, read or not.
+
+	@param r the ring, or NULL to do nothing
+	@param kind what happened
+	@param time the simulated time it happened at
+	@param job the job it happened to
+	@param core the core it happened on, -1 if none
+ */
+void telemetry_event(tel_ring_t *r, tel_kind_t kind, int time, int job, int core)
+{
+	if (r == NULL)
+		return;
+
+	unsigned long long h = atomic_load_explicit(&r->head, memory_order_relaxed);
+	tel_slot_t *s = &r->slot[h & (TEL_SLOTS - 1)];
+
+	// Sequence lock, a reader copying the slot meanwhile sees seq change and drops it
+	atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&s->kind, kind, memory_order_relaxed);
+	atomic_store_explicit(&s->time, time, memory_order_relaxed);
+	atomic_store_explicit(&s->job, job, memory_order_relaxed);
+	atomic_store_explicit(&s->core, core, memory_order_relaxed);
+	atomic_store_explicit(&s->seq, h + 1, memory_order_release);
+
+	atomic_store_explicit(&r->head, h + 1, memory_order_release);
+	atomic_fetch_add_explicit(&r->events[kind], 1, memory_order_relaxed);
+}
+
+
+/**
+	Publishes the counters of the time unit just simulated.
+
+	@param r the ring, or NULL to do nothing
+	@param time the simulated time
+	@param depth jobs waiting in the queue
+	@param busy cores running a job
+ */
+void telemetry_counters(tel_ring_t *r, int time, int depth, int busy)
+{
+	if (r == NULL)
+		return;
+
+	atomic_store_explicit(&r->depth, depth, memory_order_relaxed);
+	atomic_store_explicit(&r->busy, busy, memory_order_relaxed);
+	atomic_store_explicit(&r->time, time, memory_order_release);
+}
+
+
+/**
+	Marks the simulation ended and removes the segment's name. Readers already
+	attached keep their mapping and can drain what is left.
+
+	@param r the ring, or NULL to do nothing
+	@param name the name it was created under
+ */
+void telemetry_close(tel_ring_t *r, const char *name)
+{
+	if (r == NULL)
+		return;
+
+	atomic_store_explicit(&r->done, 1, memory_order_release);
+	munmap(r, sizeof(tel_ring_t));
+	shm_unlink(name);
+}
+
+
+//	------------------------------------------------------------------------------------------
+//	Reader
+//	------------------------------------------------------------------------------------------
+/**
+	Maps the segment name read-only, starting at the oldest event still in the ring.
+
+	@param rd the reader to set up
+	@param name the name the simulator publishes under
+	@return 1 on success, 0 if there is no such segment or it is not a ring
+ */
+int telemetry_attach(tel_reader_t *rd, const char *name)
+{
+	struct stat st;
+	tel_ring_t *r;
+	unsigned long long head;
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd == -1)
+		return 0;
+
+	// The writer may not have sized the segment yet
+	if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(tel_ring_t))
+	{
+		close(fd);
+		return 0;
+	}
+	r = (tel_ring_t*) mmap(NULL, sizeof(tel_ring_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (r == MAP_FAILED)
+		return 0;
+	if (r->magic != TEL_MAGIC)
+	{
+		munmap(r, sizeof(tel_ring_t));
+		return 0;
+	}
+	atomic_thread_fence(memory_order_acquire);
+
+	head = atomic_load_explicit(&r->head, memory_order_acquire);
+	rd->ring = r;
+	rd->tail = (head > TEL_SLOTS) ? head - TEL_SLOTS : 0;
+	rd->lost = 0;
+	return 1;
+}
+
+
+/**
+	Takes the next event, skipping over any the writer has overwritten.
+
+	@param rd the reader
+	@param ev where to store the event
+	@return 1 if an event was read, 0 if the reader has caught up
+ */
+int telemetry_read(tel_reader_t *rd, tel_event_t *ev)
+{
+	unsigned long long head = atomic_load_explicit(&rd->ring->head, memory_order_acquire);
+
+	while (rd->tail < head)
+	{
+		if (head - rd->tail > TEL_SLOTS)
+		{
+			rd->lost += head - rd->tail - TEL_SLOTS;
+			rd->tail = head - TEL_SLOTS;
+		}
+
+		unsigned long long want = ++rd->tail;
+		tel_slot_t *s = &rd->ring->slot[(want - 1) & (TEL_SLOTS - 1)];
+		unsigned long long seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+		ev->kind = atomic_load_explicit(&s->kind, memory_order_relaxed);
+		ev->time = atomic_load_explicit(&s->time, memory_order_relaxed);
+		ev->job = atomic_load_explicit(&s->job, memory_order_relaxed);
+		ev->core = atomic_load_explicit(&s->core, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+
+		if (seq == want && atomic_load_explicit(&s->seq, memory_order_relaxed) == want)
+			return 1;
+		rd->lost++;
+		head = atomic_load_explicit(&rd->ring->head, memory_order_acquire);
+	}
+	return 0;
+}
+
+
+/**
+	Tells whether the writer is gone, having ended the simulation or not.
+
+	@param rd the reader
+	@return 1 once no more events will be written, else 0
+ */
+int telemetry_ended(tel_reader_t *rd)
+{
+	if (atomic_load_explicit(&rd->ring->done, memory_order_acquire))
+		return 1;
+	return kill(rd->ring->pid, 0) == -1 && errno == ESRCH;
+}
+
+
+/**
+	Unmaps the ring.
+
+	@param rd the reader
+ */
+void telemetry_detach(tel_reader_t *rd)
+{
+	munmap(rd->ring, sizeof(tel_ring_t));
+	rd->ring = NULL;
+}
@@ -0,0 +1,83 @@
+/** @file libtelemetry.h
+ */
+
+#ifndef LIBTELEMETRY_H_
+#define LIBTELEMETRY_H_
+#include <stdatomic.h>
+
+//	Events the ring holds, a power of two. A reader further behind than this loses the
+//	oldest events; the writer never waits for readers.
+#define TEL_SLOTS		(1 << 16)
+#define TEL_MAGIC		0x54454C31
+
+//
+//	Kinds of event
+//
+typedef enum {TEL_ARRIVAL = 0, TEL_DISPATCH, TEL_PREEMPT, TEL_FINISH, TEL_KINDS} tel_kind_t;
+
+//
+//	One event as a reader receives it; core is -1 for an arrival
+//
+typedef struct _tel_event_t
+{
+	int kind;
+	int time;
+	int job;
+	int core;
+} tel_event_t;
+
+//
+//	One event as it sits in the ring. seq is the event's index plus one once written and
+//	0 while it is being written, so a reader can tell a slot overwritten under it.
+//
+typedef struct _tel_slot_t
+{
+	atomic_ullong seq;
+	atomic_int kind;
+	atomic_int time;
+	atomic_int job;
+	atomic_int core;
+} tel_slot_t;
+
+/**
+  Shared Memory Segment, a single-producer ring of events and the latest counters
+*/
+typedef struct _tel_ring_t
+{
+	unsigned int magic;
+	int cores;					//	Cores the simulation may bring online
+	int pid;					//	The writer, whose exit without setting done also ends the ring
+	atomic_int done;			//	Set once the simulation has ended
+
+	atomic_int time;			//	Counters as of the latest time unit simulated
+	atomic_int depth;
+	atomic_int busy;
+	atomic_llong events[TEL_KINDS];
+
+	atomic_ullong head;			//	Events written so far
+	tel_slot_t slot[TEL_SLOTS];
+} tel_ring_t;
+
+//
+//	A reader's position in the ring
+//
+typedef struct _tel_reader_t
+{
+	tel_ring_t *ring;
+	unsigned long long tail;	//	Events consumed or lost so far
+	long long lost;				//	Events overwritten before they were read
+} tel_reader_t;
+
+
+tel_ring_t*	telemetry_create	(const char *name, int cores);
+void		telemetry_event		(tel_ring_t *r, tel_kind_t kind, int time, int job, int core);
+void		telemetry_counters	(tel_ring_t *r, int time, int depth, int busy);
+void		telemetry_close		(tel_ring_t *r, const char *name);
+
+int			telemetry_attach	(tel_reader_t *rd, const char *name);
+int			telemetry_read		(tel_reader_t *rd, tel_event_t *ev);
+int			telemetry_ended		(tel_reader_t *rd);
+void		telemetry_detach	(tel_reader_t *rd);
+
+
+#endif /* LIBTELEMETRY_H_ */
@@ -0,0 +1,461 @@
+/** @file live.c
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "libscheduler/libscheduler.h"
+
+
+/*
+ * Live mode: libscheduler's decisions drive real processes instead of the
+ * simulated clock.  Each job becomes a CPU-bound worker (this program run
+ * again with -w) which burns run_time time units of CPU time and exits.
+ * Core i is the i-th CPU this process may run on; a job is pinned to its
+ * core's CPU with sched_setaffinity, stopped with SIGSTOP when it loses the
+ * core and resumed with SIGCONT when it gets one back.  Time advances in ticks
+ * of -u milliseconds of wall-clock time.
+ */
+typedef struct _live_job_t
+{
+	int job_id, arrival_time, run_time, priority, deadline;
+	int core_id;
+	int done;						// The worker has exited
+	int reported;					// The scheduler has been told the job finished
+	pid_t pid;						// 0 until first dispatched
+	double arrived_at, first_run_at, finished_at;
+} live_job_t;
+
+live_job_t *live_jobs;
+int *core_job;						// Index in live_jobs of the job on each core, -1 if idle
+int *core_cpu;						// CPU each core is pinned to
+int *core_expiry;					// Tick at which each core's quantum runs out, -1 if none
+int scheme, quantum = 0, unit = 10;
+int remaining;						// Jobs the scheduler has not seen finish
+char *self;
+
+double dispatch_total = 0;			// Tick start to the worker forked or resumed, in us
+long long dispatch_n = 0;
+double decide_total = 0, decide_max = 0;	// Time spent inside scheduler calls, in us
+long long decide_n = 0;
+
+
+double now_us()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+void decided(double since)
+{
+	double d = now_us() - since;
+	decide_total += d;
+	if (d > decide_max)
+		decide_max = d;
+	decide_n++;
+}
+
+/*
+ * The worker: spins until it has been given ms milliseconds of CPU time.
+ * Time spent stopped does not count.
+ */
+int worker(long ms)
+{
+	struct timespec t;
+	do
+	{
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+	} while (t.tv_sec * 1000L + t.tv_nsec / 1000000L < ms);
+	return 0;
+}
+
+void pin(pid_t pid, int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (sched_setaffinity(pid, sizeof(set), &set) != 0)
+		perror("sched_setaffinity");
+}
+
+/*
+ * Stops the worker of job j and waits until it is stopped, so the CPU is free
+ * before anything else is started on it.  Returns 0 if the worker turned out
+ * to have exited first.
+ */
+int stop_job(int j)
+{
+	int status;
+
+	live_jobs[j].core_id = -1;
+	kill(live_jobs[j].pid, SIGSTOP);
+	if (waitpid(live_jobs[j].pid, &status, WUNTRACED) == live_jobs[j].pid && !WIFSTOPPED(status))
+	{
+		live_jobs[j].done = 1;
+		live_jobs[j].finished_at = now_us();
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Gives core c to job j at tick t, forking its worker on first dispatch.
+ */
+void run_job(int j, int c, int t, double tick_at)
+{
+	char ms[32];
+
+	core_job[c] = j;
+	live_jobs[j].core_id = c;
+
+	if (live_jobs[j].pid == 0)
+	{
+		live_jobs[j].first_run_at = now_us();
+		live_jobs[j].pid = fork();
+		if (live_jobs[j].pid == 0)
+		{
+			pin(0, core_cpu[c]);
+			snprintf(ms, sizeof(ms), "%ld", (long)live_jobs[j].run_time * unit);
+			execl("/proc/self/exe", self, "-w", ms, (char *)NULL);
+			perror("execl");
+			_exit(127);
+		}
+		else if (live_jobs[j].pid < 0)
+		{
+			perror("fork");
+			exit(3);
+		}
+	}
+	else
+	{
+		pin(live_jobs[j].pid, core_cpu[c]);
+		kill(live_jobs[j].pid, SIGCONT);
+	}
+
+	dispatch_total += now_us() - tick_at;
+	dispatch_n++;
+
+	int slice = (scheme == RR) ? quantum : (scheme == CFS) ? scheduler_time_slice(c) : -1;
+	core_expiry[c] = (slice > 0) ? t + slice : -1;
+}
+
+/*
+ * Tells the scheduler job j finished on core c and starts whatever it picks
+ * next.  A job that exited while being preempted is only reported once it
+ * would have been given a core again.
+ */
+void finish_job(int j, int c, int t, double tick_at)
+{
+	double since;
+
+	while (j != -1)
+	{
+		core_job[c] = -1;
+		core_expiry[c] = -1;
+		live_jobs[j].core_id = -1;
+		live_jobs[j].reported = 1;
+		remaining--;
+
+		since = now_us();
+		j = scheduler_job_finished(c, live_jobs[j].job_id, t);
+		decided(since);
+
+		if (j == -1)
+			break;
+		core_job[c] = j;
+		if (!live_jobs[j].done)
+		{
+			run_job(j, c, t, tick_at);
+			break;
+		}
+	}
+}
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s -c <cores> -s <scheme> [-u <ms>] <input file>\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Runs the jobs as real CPU-bound processes, one CPU per core, dispatched by\n");
+	fprintf(stderr, "libscheduler.  Acceptable schemes are: fcfs, sjf, psjf, pri, ppri, rr#, cfs[#],\n");
+	fprintf(stderr, "edf, pedf.  Option -u <ms> sets the length of a time unit (default 10).\n");
+	fprintf(stderr, "Only -c 1 is supported for now; pinning several cores is untested.\n");
+}
+
+
+int main(int argc, char **argv)
+{
+	int c, i, j, t;
+	int cores = 0, cpus = 0;
+	char *file_name;
+
+	self = argv[0];
+	scheme = -1;
+
+	while ((c = getopt(argc, argv, "c:s:u:w:")) != -1)
+	{
+		switch (c)
+		{
+			case 'w':
+				return worker(atol(optarg));
+
+			case 'c':
+				cores = atoi(optarg);
+
+				if (cores <= 0)
+				{
+					fprintf(stderr, "Option -c <cores> require a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				// Refused until several pinned cores have been tried on a multi-CPU machine
+				if (cores > 1)
+				{
+					fprintf(stderr, "Option -c <cores> supports a single core only.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'u':
+				unit = atoi(optarg);
+				break;
+
+			case 's':
+				if (strcasecmp(optarg, "FCFS") == 0) { scheme = FCFS; }
+				else if (strcasecmp(optarg, "SJF") == 0) { scheme = SJF; }
+				else if (strcasecmp(optarg, "PSJF") == 0) { scheme = PSJF; }
+				else if (strcasecmp(optarg, "PRI") == 0) { scheme = PRI; }
+				else if (strcasecmp(optarg, "PPRI") == 0) { scheme = PPRI; }
+				else if (strcasecmp(optarg, "EDF") == 0) { scheme = EDF; }
+				else if (strcasecmp(optarg, "PEDF") == 0) { scheme = PEDF; }
+				else if (strncasecmp(optarg, "CFS", 3) == 0)
+				{
+					scheme = CFS;
+					quantum = (optarg[3] == '\0') ? 6 : atoi(optarg + 3);
+				}
+				else if (strncasecmp(optarg, "RR", 2) == 0)
+				{
+					scheme = RR;
+					quantum = atoi(optarg + 2);
+				}
+				break;
+
+			case '?':
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (cores <= 0 || scheme == -1 || quantum < 0 || (scheme >= RR && scheme <= CFS && quantum == 0) || unit <= 0 || optind != argc - 1)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+	file_name = argv[optind];
+
+
+	/*
+	 * Read the live_jobs, in the simulator's input format.
+	 */
+	FILE *file = fopen(file_name, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Unable to open file \"%s\".\n", file_name);
+		return 2;
+	}
+
+	int job_n = 0, jobs_ct = 10;
+	char line[1024 + 1];
+	live_jobs = malloc(jobs_ct * sizeof(live_job_t));
+
+	fgets(line, 1024, file);  // Ignore the first (header) line
+	while (fgets(line, 1024, file) != NULL)
+	{
+		char *arrival_time = strtok(line, ",");
+		char *run_time = strtok(NULL, ",");
+		char *priority = strtok(NULL, ",");
+		char *deadline = strtok(NULL, ",");
+
+		if (arrival_time == NULL || run_time == NULL || priority == NULL)
+		{
+			fprintf(stderr, "Illegal file format.\n");
+			return 2;
+		}
+
+		if (job_n == jobs_ct)
+		{
+			jobs_ct *= 2;
+			live_jobs = realloc(live_jobs, jobs_ct * sizeof(live_job_t));
+		}
+
+		memset(&live_jobs[job_n], 0, sizeof(live_job_t));
+		live_jobs[job_n].job_id = job_n;
+		live_jobs[job_n].arrival_time = atoi(arrival_time);
+		live_jobs[job_n].run_time = atoi(run_time);
+		live_jobs[job_n].priority = atoi(priority);
+		live_jobs[job_n].deadline = -1;
+		if (deadline != NULL && strspn(deadline, " \t\r\n") != strlen(deadline))
+			live_jobs[job_n].deadline = atoi(deadline);
+		live_jobs[job_n].core_id = -1;
+		job_n++;
+	}
+	fclose(file);
+
+
+	/*
+	 * Core i runs on the i-th CPU we are allowed; extra cores share CPUs.
+	 */
+	cpu_set_t allowed;
+	core_cpu = malloc(cores * sizeof(int));
+	core_job = malloc(cores * sizeof(int));
+	core_expiry = malloc(cores * sizeof(int));
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+	{
+		perror("sched_getaffinity");
+		return 3;
+	}
+	for (i = 0; i < CPU_SETSIZE && cpus < cores; i++)
+		if (CPU_ISSET(i, &allowed))
+			core_cpu[cpus++] = i;
+	for (i = cpus; i < cores; i++)
+		core_cpu[i] = core_cpu[i % cpus];
+	if (cpus < cores)
+		fprintf(stderr, "Only %d CPU(s) available, %d core(s) will share them.\n", cpus, cores);
+
+	for (i = 0; i < cores; i++)
+	{
+		core_job[i] = -1;
+		core_expiry[i] = -1;
+	}
+
+	printf("Running %d job(s) live on %d core(s), %d ms per time unit...\n\n", job_n, cores, unit);
+
+	scheduler_start_up(cores, scheme);
+	if (scheme == CFS)
+		scheduler_set_latency(quantum);
+
+
+	/*
+	 * Run.  Each tick reaps finished workers, expires quanta and admits
+	 * arrivals, in the simulator's order, then sleeps to the next tick.
+	 */
+	double start = now_us();
+	remaining = job_n;
+
+	for (t = 0; remaining > 0; t++)
+	{
+		double tick_at = start + (double)t * unit * 1000;
+		double wait = tick_at - now_us();
+		if (wait > 0)
+		{
+			struct timespec ts = { (time_t)(wait / 1e6), (long)((wait - (time_t)(wait / 1e6) * 1e6) * 1000) };
+			while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+				;
+		}
+		tick_at = now_us();
+
+		// 1. Workers which exited
+		pid_t pid;
+		int status;
+		while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+		{
+			for (i = 0; i < cores; i++)
+			{
+				j = core_job[i];
+				if (j != -1 && live_jobs[j].pid == pid)
+				{
+					live_jobs[j].done = 1;
+					live_jobs[j].finished_at = tick_at;
+					finish_job(j, i, t, tick_at);
+					break;
+				}
+			}
+		}
+
+		// 2. Quantum expirations
+		for (i = 0; i < cores; i++)
+		{
+			if (core_expiry[i] != t || core_job[i] == -1)
+				continue;
+
+			int old = core_job[i];
+			double since = now_us();
+			j = scheduler_quantum_expired(i, t);
+			decided(since);
+
+			if (j == old)
+			{
+				run_job(j, i, t, tick_at);
+				continue;
+			}
+			// A worker which exits before it stops is reported once picked again
+			core_job[i] = -1;
+			stop_job(old);
+			if (j != -1)
+			{
+				if (live_jobs[j].done)
+					finish_job(j, i, t, tick_at);
+				else
+					run_job(j, i, t, tick_at);
+			}
+		}
+
+		// 3. Arrivals
+		for (j = 0; j < job_n; j++)
+		{
+			if (live_jobs[j].arrival_time != t)
+				continue;
+
+			live_jobs[j].arrived_at = tick_at;
+			double since = now_us();
+			c = scheduler_new_job_deadline(live_jobs[j].job_id, t, live_jobs[j].run_time, live_jobs[j].priority, live_jobs[j].deadline);
+			decided(since);
+
+			if (c >= 0 && c < cores)
+			{
+				if (core_job[c] != -1)
+					stop_job(core_job[c]);
+				run_job(j, c, t, tick_at);
+			}
+		}
+	}
+
+
+	/*
+	 * Compare what the scheduler believes with what the processes saw.
+	 */
+	double wait = 0, turn = 0, resp = 0, per_unit = unit * 1000.0;
+	for (j = 0; j < job_n; j++)
+	{
+		turn += (live_jobs[j].finished_at - live_jobs[j].arrived_at) / per_unit;
+		wait += (live_jobs[j].finished_at - live_jobs[j].arrived_at) / per_unit - live_jobs[j].run_time;
+		resp += (live_jobs[j].first_run_at - live_jobs[j].arrived_at) / per_unit;
+	}
+
+	printf("Finished after %d time units.\n\n", t);
+	printf("Average Waiting Time: %.2f (scheduler), %.2f (real)\n", scheduler_average_waiting_time(), job_n ? wait / job_n : 0.0);
+	printf("Average Turnaround Time: %.2f (scheduler), %.2f (real)\n", scheduler_average_turnaround_time(), job_n ? turn / job_n : 0.0);
+	printf("Average Response Time: %.2f (scheduler), %.2f (real)\n", scheduler_average_response_time(), job_n ? resp / job_n : 0.0);
+	printf("Average Dispatch Latency: %.1f us\n", dispatch_n ? dispatch_total / dispatch_n : 0.0);
+	printf("Scheduler Decision Time: %.2f us average, %.2f us maximum over %lld calls\n",
+			decide_n ? decide_total / decide_n : 0.0, decide_max, decide_n);
+
+	scheduler_clean_up();
+	free(core_cpu);
+	free(core_job);
+	free(core_expiry);
+	free(live_jobs);
+
+	return 0;
+}
@@ -0,0 +1,32 @@
+/** @file lcfs.c
+ */
+
+#include "libscheduler/libscheduler.h"
+
+/*
+ * Preemptive Last Come First Served, a sample policy plugin.  The newest job
+ * always runs: an arrival takes a core from whichever running job the built-in
+ * victim choice picks, and the displaced job waits behind every later arrival.
+ *
+ *     make plugins/lcfs.so && ./simulator -c 2 -s plugin:./plugins/lcfs.so examples/proc1.csv
+ */
+int lcfs_cmp(int j1, int j2)
+{
+	return (int)(JOB_ARR(j2) - JOB_ARR(j1));
+}
+
+int lcfs_outrank(int job, int running)
+{
+	int c = lcfs_cmp(job, running);
+	return (c < 0) ? -c : 0;
+}
+
+static const policy_t LCFS =
+{
+	"lcfs", &lcfs_cmp, &lcfs_outrank, NULL, NULL, NULL, PQ_LIST
+};
+
+const policy_t *scheduler_plugin()
+{
+	return &LCFS;
+}
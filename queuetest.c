@@ -16,6 +16,11 @@ int compare2(const void * a, const void * b)
 	return ( *(int*)b - *(int*)a );
 }
 
+int key1(const void * a)
+{
+	return ( *(int*)a / 10 );
+}
+
 int main()
 {
 	priqueue_t q, q2;
@@ -65,6 +70,69 @@ int main()
 		printf("%d ", *((int *)priqueue_at(&q2, i)) );
 	printf("\n");
 
+	/* Repeat with the red-black tree backing store. */
+	priqueue_t q3;
+	priqueue_init_rb(&q3, compare1);
+
+	priqueue_offer(&q3, &values[12]);
+	priqueue_offer(&q3, &values[13]);
+	priqueue_offer(&q3, &values[14]);
+	priqueue_offer(&q3, &values[12]);
+	priqueue_offer(&q3, &values[12]);
+	printf("Tree total elements: %d (expected 5).\n", priqueue_size(&q3));
+
+	val = *((int *)priqueue_poll(&q3));
+	printf("Tree top element: %d (expected 12).\n", val);
+
+	vals_removed = priqueue_remove(&q3, &values[12]);
+	printf("Tree elements removed: %d (expected 2).\n", vals_removed);
+
+	priqueue_offer(&q3, &values[10]);
+	priqueue_offer(&q3, &values[30]);
+	priqueue_offer(&q3, &values[20]);
+
+	printf("Elements in order tree (expected 10 13 14 20 30): ");
+	for (i = 0; i < priqueue_size(&q3); i++)
+		printf("%d ", *((int *)priqueue_at(&q3, i)) );
+	printf("\n");
+
+	/* And with the bucket backing store, one bucket per ten values. */
+	priqueue_t q4;
+	priqueue_init_bucket(&q4, compare1, key1, 10);
+
+	priqueue_offer(&q4, &values[30]);
+	priqueue_offer(&q4, &values[14]);
+	priqueue_offer(&q4, &values[12]);
+	priqueue_offer(&q4, &values[20]);
+	priqueue_offer(&q4, &values[13]);
+	printf("Bucket top element: %d (expected 12).\n", *((int *)priqueue_peek(&q4)));
+
+	vals_removed = priqueue_remove(&q4, &values[20]);
+	printf("Bucket elements removed: %d (expected 1).\n", vals_removed);
+
+	printf("Elements in order buckets (expected 12 13 14 30): ");
+	for (i = 0; i < priqueue_size(&q4); i++)
+		printf("%d ", *((int *)priqueue_at(&q4, i)) );
+	printf("\n");
+
+	/* And with the ring buffer backing store. */
+	priqueue_t q5;
+	priqueue_init_fifo(&q5, compare1);
+
+	for (i = 0; i < 40; i++)
+		priqueue_offer(&q5, &values[i + 10]);
+	priqueue_offer(&q5, &values[5]);
+	for (i = 0; i < 38; i++)
+		priqueue_poll(&q5);
+
+	printf("Elements in order ring (expected 47 48 49): ");
+	for (i = 0; i < priqueue_size(&q5); i++)
+		printf("%d ", *((int *)priqueue_at(&q5, i)) );
+	printf("\n");
+
+	priqueue_destroy(&q5);
+	priqueue_destroy(&q4);
+	priqueue_destroy(&q3);
 	priqueue_destroy(&q2);
 	priqueue_destroy(&q);
 
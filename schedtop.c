@@ -0,0 +1,137 @@
+/** @file schedtop.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "libtelemetry/libtelemetry.h"
+
+
+/*
+ * schedtop: follows a simulation started with -M <name>, printing a line of
+ * throughput every interval: simulated time units and events per second of
+ * wall-clock time, the queue depth and busy cores, and events the reader fell
+ * too far behind to see.  Exits once the simulation has ended or its process
+ * is gone.
+ */
+#define DRAIN_MS	5
+
+static const char *kind_name[TEL_KINDS] = { "arrive/s", "dispatch/s", "preempt/s", "finish/s" };
+
+double now_s()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void print_header()
+{
+	int k;
+	printf("%10s %10s", "time", "units/s");
+	for (k = 0; k < TEL_KINDS; k++)
+		printf(" %10s", kind_name[k]);
+	printf(" %8s %6s %10s %8s\n", "queued", "busy", "finished", "lost");
+}
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s [-i <ms>] [-n <lines>] [<name>]\n", program_name);
+	fprintf(stderr, "       %s /scheduler\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Watches a simulator run with -M <name> (default /scheduler), waiting for it to\n");
+	fprintf(stderr, "start.  Option -i <ms> sets the refresh interval (default 1000) and -n <lines>\n");
+	fprintf(stderr, "stops after that many lines.\n");
+}
+
+int main(int argc, char **argv)
+{
+	int c, k, lines = 0, max_lines = 0, interval = 1000;
+	const char *name = "/scheduler";
+	tel_reader_t rd;
+	tel_event_t ev;
+
+	while ((c = getopt(argc, argv, "i:n:")) != -1)
+	{
+		switch (c)
+		{
+			case 'i':
+				interval = atoi(optarg);
+				if (interval <= 0)
+				{
+					fprintf(stderr, "Option -i <ms> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'n':
+				max_lines = atoi(optarg);
+				break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+	if (optind < argc)
+		name = argv[optind];
+
+	while (!telemetry_attach(&rd, name))
+		usleep(DRAIN_MS * 1000);
+
+	long long count[TEL_KINDS] = { 0 };
+	int last_time = atomic_load(&rd.ring->time);
+	double last = now_s();
+
+	/*
+	 * Drain the ring every DRAIN_MS, printing every interval.  The writer never
+	 * waits, so a reader which falls a whole ring behind loses the oldest events
+	 * and counts them as lost.
+	 */
+	for (;;)
+	{
+		int done;
+		double at;
+
+		do
+		{
+			// Read before draining, so the last drain sees every event
+			done = telemetry_ended(&rd);
+			usleep(DRAIN_MS * 1000);
+			while (telemetry_read(&rd, &ev))
+			{
+				if (ev.kind >= 0 && ev.kind < TEL_KINDS)
+					count[ev.kind]++;
+			}
+			at = now_s();
+		} while (!done && at - last < interval / 1000.0);
+
+		double dt = at - last;
+		int time = atomic_load(&rd.ring->time);
+
+		if (lines % 20 == 0)
+			print_header();
+		printf("%10d %10.1f", time, (time - last_time) / dt);
+		for (k = 0; k < TEL_KINDS; k++)
+		{
+			printf(" %10.1f", count[k] / dt);
+			count[k] = 0;
+		}
+		printf(" %8d %6d %10lld %8lld\n", atomic_load(&rd.ring->depth), atomic_load(&rd.ring->busy),
+				atomic_load(&rd.ring->events[TEL_FINISH]), rd.lost);
+		fflush(stdout);
+
+		last = at;
+		last_time = time;
+		lines++;
+		if (done || (max_lines > 0 && lines >= max_lines))
+			break;
+	}
+
+	telemetry_detach(&rd);
+	return 0;
+}
@@ -1,41 +1,1077 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <string.h>
 #include <assert.h>
+#include <ctype.h>
+#include <limits.h>
+#include <dlfcn.h>
 
 #include "libscheduler/libscheduler.h"
+#include "libtelemetry/libtelemetry.h"
 
 
 typedef struct _simulator_job_list_t
 {
-	int job_id, arrival_time, run_time, priority;
+	int job_id, arrival_time, run_time, priority, deadline, width;
+	int job_class, estimate, tenant;
 	int core_id, arrived;
+	int last_core, stall;
+	long long work;
 } simulator_job_list_t;
 
+
+/*
+ * Context-switch cost model.  A core which starts a job other than the one it
+ * last ran stalls for switch_cost time units; a job resumed on a core other
+ * than the one it last ran on stalls a further migrate_cost units while its
+ * cache warms up.  Stalled time counts against the job but does not run it.
+ */
+int switch_cost = 0, migrate_cost = 0;
+int *core_last_job;
+long long overhead_time = 0;
+
+/*
+ * Work each core retires per time unit, in 1/SPEED_UNIT time units.
+ */
+int *core_speed;
+
+/*
+ * Slot in the jobs array of the job running on each core, -1 if idle.
+ */
+int *core_job;
+
+/*
+ * Slot in the jobs array of each job, by job id, -1 once it has finished.
+ */
+int *job_slot;
+int job_total = 0;
+
+
+/*
+ * Quantum expirations, a min-heap ordered by expiry time then core.  Each core
+ * has a sequence number which is bumped whenever its quantum restarts or is
+ * abandoned; heap entries carrying an older number are stale and skipped.
+ */
+typedef struct _expiry_t
+{
+	int at, core_id, seq;
+} expiry_t;
+
+expiry_t *expiry_heap;
+int expiry_n = 0, expiry_cap = 0;
+int *expiry_seq;
+
+int expiry_before(expiry_t *a, expiry_t *b)
+{
+	return (a->at != b->at) ? a->at < b->at : a->core_id < b->core_id;
+}
+
+void expiry_push(int at, int core_id)
+{
+	if (expiry_n == expiry_cap)
+	{
+		expiry_cap = (expiry_cap == 0) ? 16 : expiry_cap * 2;
+		expiry_heap = realloc(expiry_heap, expiry_cap * sizeof(expiry_t));
+	}
+
+	int i = expiry_n++;
+	expiry_t e = { at, core_id, expiry_seq[core_id] };
+	while (i > 0 && expiry_before(&e, &expiry_heap[(i - 1) / 2]))
+	{
+		expiry_heap[i] = expiry_heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	expiry_heap[i] = e;
+}
+
+/*
+ * Removes and returns the core of the earliest live expiration due at or before
+ * time, or -1 if there is none.
+ */
+int expiry_pop(int time)
+{
+	while (expiry_n > 0 && expiry_heap[0].at <= time)
+	{
+		expiry_t top = expiry_heap[0];
+		expiry_t last = expiry_heap[--expiry_n];
+		int i = 0, c;
+
+		while ((c = 2 * i + 1) < expiry_n)
+		{
+			if (c + 1 < expiry_n && expiry_before(&expiry_heap[c + 1], &expiry_heap[c]))
+				c++;
+			if (!expiry_before(&expiry_heap[c], &last))
+				break;
+			expiry_heap[i] = expiry_heap[c];
+			i = c;
+		}
+		if (expiry_n > 0)
+			expiry_heap[i] = last;
+
+		if (top.seq == expiry_seq[top.core_id])
+			return top.core_id;
+	}
+	return -1;
+}
+
+/*
+ * The policy being simulated, built in or loaded with -s plugin:<path>.
+ */
+const policy_t *policy;
+
+/*
+ * (Re)starts the quantum of the job just dispatched on core_id.  The quantum
+ * only starts counting once the job's switch overhead has been paid.  A policy
+ * which sizes its own slices overrides the quantum given with -s.
+ */
+void start_quantum(int core_id, int time, int stall, int quantum)
+{
+	expiry_seq[core_id]++;
+	if (policy->on_quantum == NULL)
+		return;
+
+	int slice = scheduler_time_slice(core_id);
+	if (slice > 0)
+		quantum = slice;
+	if (quantum > 0)
+		expiry_push(time + stall + quantum, core_id);
+}
+
+/*
+ * Slots of the jobs whose work ran out in the last time unit, a min-heap so
+ * they are retired in slot order.  Entries whose slot has since been vacated
+ * or refilled by another job are stale and skipped.
+ */
+int *finish_heap;
+int finish_n = 0;
+
+void finish_push(int slot)
+{
+	int i = finish_n++;
+	while (i > 0 && slot < finish_heap[(i - 1) / 2])
+	{
+		finish_heap[i] = finish_heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	finish_heap[i] = slot;
+}
+
+int finish_pop()
+{
+	if (finish_n == 0)
+		return -1;
+
+	int top = finish_heap[0];
+	int last = finish_heap[--finish_n];
+	int i = 0, c;
+
+	while ((c = 2 * i + 1) < finish_n)
+	{
+		if (c + 1 < finish_n && finish_heap[c + 1] < finish_heap[c])
+			c++;
+		if (finish_heap[c] >= last)
+			break;
+		finish_heap[i] = finish_heap[c];
+		i = c;
+	}
+	if (finish_n > 0)
+		finish_heap[i] = last;
+
+	return top;
+}
+
+/*
+ * Arrival cursor: the job ids ordered by arrival time, consumed as time passes.
+ */
+typedef struct _arrival_t
+{
+	int at, job_id;
+} arrival_t;
+
+int arrival_compare(const void *a, const void *b)
+{
+	const arrival_t *x = a, *y = b;
+	return (x->at != y->at) ? (x->at > y->at) - (x->at < y->at) : x->job_id - y->job_id;
+}
+
+int slot_compare(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+/*
+ * Jobs admission control deferred (-D), a min-heap of the times they are to be
+ * offered again, in arrival order.
+ */
+arrival_t *retry_heap;
+int retry_n = 0, retry_cap = 0;
+int retry_delay = 0;
+
+void retry_push(int at, int job_id)
+{
+	if (retry_n == retry_cap)
+	{
+		retry_cap = (retry_cap == 0) ? 16 : retry_cap * 2;
+		retry_heap = realloc(retry_heap, retry_cap * sizeof(arrival_t));
+	}
+
+	int i = retry_n++;
+	arrival_t e = { at, job_id };
+	while (i > 0 && arrival_compare(&e, &retry_heap[(i - 1) / 2]) < 0)
+	{
+		retry_heap[i] = retry_heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	retry_heap[i] = e;
+}
+
+/*
+ * Removes and returns the job id of the earliest retry due at or before time,
+ * or -1 if there is none.
+ */
+int retry_pop(int time)
+{
+	if (retry_n == 0 || retry_heap[0].at > time)
+		return -1;
+
+	arrival_t top = retry_heap[0];
+	arrival_t last = retry_heap[--retry_n];
+	int i = 0, c;
+
+	while ((c = 2 * i + 1) < retry_n)
+	{
+		if (c + 1 < retry_n && arrival_compare(&retry_heap[c + 1], &retry_heap[c]) < 0)
+			c++;
+		if (arrival_compare(&retry_heap[c], &last) >= 0)
+			break;
+		retry_heap[i] = retry_heap[c];
+		i = c;
+	}
+	if (retry_n > 0)
+		retry_heap[i] = last;
+
+	return top.job_id;
+}
+
+/*
+ * Arrival rate limits (-B), one token bucket per priority.
+ */
+typedef struct _rate_limit_t
+{
+	int priority, burst;
+	float rate;
+} rate_limit_t;
+
+/*
+ * Parses a comma separated list of priority:rate[:burst] entries.  Returns the
+ * number of entries, or -1 if one is malformed.
+ */
+int load_rate_limits(char *spec, rate_limit_t **limits)
+{
+	char *tok, *colon;
+	int n = 0;
+
+	for (tok = strtok(spec, ","); tok != NULL; tok = strtok(NULL, ","))
+	{
+		colon = strchr(tok, ':');
+		if (colon == NULL || atof(colon + 1) <= 0)
+			return -1;
+
+		*limits = realloc(*limits, (n + 1) * sizeof(rate_limit_t));
+		(*limits)[n].priority = atoi(tok);
+		(*limits)[n].rate = atof(colon + 1);
+		(*limits)[n].burst = (strchr(colon + 1, ':') != NULL) ? atoi(strchr(colon + 1, ':') + 1) : 1;
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Fair share weights (-U), one per tenant listed.
+ */
+typedef struct _tenant_weight_t
+{
+	int tenant, weight;
+} tenant_weight_t;
+
+/*
+ * Parses a comma separated list of tenant:weight entries.  Returns the number
+ * of entries, or -1 if one is malformed.
+ */
+int load_tenant_weights(char *spec, tenant_weight_t **weights)
+{
+	char *tok, *colon;
+	int n = 0;
+
+	for (tok = strtok(spec, ","); tok != NULL; tok = strtok(NULL, ","))
+	{
+		colon = strchr(tok, ':');
+		if (colon == NULL || atoi(tok) < 0 || atoi(tok) >= TENANTS_MAX || atoi(colon + 1) < 1)
+			return -1;
+
+		*weights = realloc(*weights, (n + 1) * sizeof(tenant_weight_t));
+		(*weights)[n].tenant = atoi(tok);
+		(*weights)[n].weight = atoi(colon + 1);
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Loads the policy a shared object exports through PLUGIN_SYMBOL, from a
+ * plugin:<path>[:<quantum>] scheme.  The quantum applies when the policy
+ * time-slices without sizing the slices itself.  Returns NULL on failure.
+ */
+const policy_t *load_plugin(char *spec, int *quantum)
+{
+	char *path = spec + strlen("plugin:");
+	char *colon = strrchr(path, ':');
+	void *handle;
+	plugin_fn entry;
+
+	if (colon != NULL && colon[1] != '\0' && strspn(colon + 1, "0123456789") == strlen(colon + 1))
+	{
+		*quantum = atoi(colon + 1);
+		*colon = '\0';
+	}
+
+	handle = dlopen(path, RTLD_NOW);
+	if (handle == NULL)
+	{
+		fprintf(stderr, "%s\n", dlerror());
+		return NULL;
+	}
+	entry = (plugin_fn)dlsym(handle, PLUGIN_SYMBOL);
+	if (entry == NULL || entry() == NULL || entry()->compare == NULL)
+	{
+		fprintf(stderr, "Plugin \"%s\" does not export a policy as %s().\n", path, PLUGIN_SYMBOL);
+		return NULL;
+	}
+	return entry();
+}
+
+/*
+ * Live telemetry (-M): arrivals, dispatches, preemptions and finishes, and the
+ * queue depth and busy cores of every time unit, published to a POSIX shared
+ * memory ring which schedtop reads.  Publishing never waits on a reader.
+ */
+tel_ring_t *telemetry = NULL;
+
+/*
+ * Chrome trace-event export (-t), readable by Perfetto and chrome://tracing.
+ * One time unit is written as one millisecond.  Each core is a thread whose
+ * slices are the jobs it ran, preceded by a "switch" slice for any overhead
+ * stall; arrivals go on a separate Queue thread, and a counter track follows
+ * the queue depth and busy cores.  Events are streamed as they happen.
+ */
+FILE *trace_file = NULL;
+int *trace_job, *trace_start, *trace_stall;
+int trace_cores, trace_depth = -1, trace_busy = -1;
+int trace_first = 1;
+
+void trace_event(const char *fmt, ...)
+{
+	va_list ap;
+
+	fputs(trace_first ? "  " : ",\n  ", trace_file);
+	trace_first = 0;
+	va_start(ap, fmt);
+	vfprintf(trace_file, fmt, ap);
+	va_end(ap);
+}
+
+int trace_begin(char *name, int cores)
+{
+	int i;
+
+	trace_file = fopen(name, "w");
+	if (trace_file == NULL)
+	{
+		fprintf(stderr, "Unable to open trace file \"%s\".\n", name);
+		return 0;
+	}
+
+	trace_cores = cores;
+	trace_job = malloc(cores * sizeof(int));
+	trace_start = malloc(cores * sizeof(int));
+	trace_stall = malloc(cores * sizeof(int));
+
+	fprintf(trace_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	trace_event("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"simulator\"}}");
+	for (i = 0; i < cores; i++)
+	{
+		trace_job[i] = -1;
+		trace_event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Core %d\"}}", i, i);
+		trace_event("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", i, i);
+	}
+	trace_event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Queue\"}}", cores);
+	trace_event("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", cores, cores);
+	return 1;
+}
+
+/*
+ * Instant event at time, on core_id's thread or, for -1, the Queue thread.
+ */
+void trace_instant(const char *name, int core_id, int time, int job_id, int other_id)
+{
+	if (trace_file == NULL)
+		return;
+
+	trace_event("{\"name\":\"%s\",\"cat\":\"event\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"args\":{\"job\":%d",
+			name, (core_id == -1) ? trace_cores : core_id, (long long)time * 1000, job_id);
+	if (other_id != -1)
+		fprintf(trace_file, ",\"by\":%d", other_id);
+	fputs("}}", trace_file);
+}
+
+/*
+ * Starts the slice of job_id on core_id, which first stalls for stall units.
+ */
+void trace_run(int core_id, int job_id, int stall, int time)
+{
+	if (trace_file == NULL)
+		return;
+
+	trace_job[core_id] = job_id;
+	trace_start[core_id] = time;
+	trace_stall[core_id] = stall;
+}
+
+/*
+ * Ends the slice running on core_id, if any.
+ */
+void trace_stop(int core_id, int time)
+{
+	if (trace_file == NULL || trace_job[core_id] == -1)
+		return;
+
+	int start = trace_start[core_id];
+	int stall = trace_stall[core_id];
+	if (stall > time - start)
+		stall = time - start;
+
+	if (stall > 0)
+		trace_event("{\"name\":\"switch\",\"cat\":\"overhead\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+				core_id, (long long)start * 1000, (long long)stall * 1000);
+	if (time > start + stall)
+		trace_event("{\"name\":\"Job %d\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"args\":{\"job\":%d}}",
+				trace_job[core_id], core_id, (long long)(start + stall) * 1000, (long long)(time - start - stall) * 1000, trace_job[core_id]);
+	trace_job[core_id] = -1;
+}
+
+/*
+ * Samples the counter track, writing only when a value changed.
+ */
+void trace_counter(int time, int depth, int busy)
+{
+	if (trace_file == NULL || (depth == trace_depth && busy == trace_busy))
+		return;
+
+	trace_event("{\"name\":\"scheduler\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{\"queued\":%d,\"busy cores\":%d}}",
+			(long long)time * 1000, depth, busy);
+	trace_depth = depth;
+	trace_busy = busy;
+}
+
+/*
+ * Marks core_id coming online or going offline and samples the count of cores
+ * online, on its own counter track.
+ */
+void trace_hotplug(int core_id, int time, int online, int cores)
+{
+	if (trace_file == NULL)
+		return;
+
+	if (core_id != -1)
+		trace_event("{\"name\":\"core %s\",\"cat\":\"hotplug\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"args\":{\"cores\":%d}}",
+				online ? "online" : "offline", core_id, (long long)time * 1000, cores);
+	trace_event("{\"name\":\"cores\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{\"online\":%d}}", (long long)time * 1000, cores);
+}
+
+void trace_end()
+{
+	if (trace_file == NULL)
+		return;
+
+	fprintf(trace_file, "\n]}\n");
+	fclose(trace_file);
+	free(trace_job);
+	free(trace_start);
+	free(trace_stall);
+}
+
 void print_usage(char *program_name)
 {
-	fprintf(stderr, "Usage: %s -c <cores> -s <scheme> <input file>\n", program_name);
+	fprintf(stderr, "Usage: %s -c <cores> -s <scheme> [options] <input file>\n", program_name);
 	fprintf(stderr, "       %s -c 2 -s fcfs examples/proc1.csv\n", program_name);
 	fprintf(stderr, "\n");
-	fprintf(stderr, "Acceptable schemes are: fcfs, sjf, psjf, pri, ppri, rr#\n");
+	fprintf(stderr, "Acceptable schemes are: fcfs, sjf, psjf, pri, ppri, rr#, cfs[#], edf, pedf, easy\n");
+	fprintf(stderr, "and plugin:<path>[:<quantum>], a policy_t a shared object returns from\n");
+	fprintf(stderr, "%s(); see plugins/lcfs.c.  A time-slicing plugin without its own\n", PLUGIN_SYMBOL);
+	fprintf(stderr, "slice length runs jobs for <quantum> time units.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Option -a <age> enables priority aging for pri and ppri: a waiting job gains\n");
+	fprintf(stderr, "one priority level every <age> time units.\n");
+	fprintf(stderr, "Option -p prints min/percentile/max tables for each timing metric.\n");
+	fprintf(stderr, "Option -v prints scheduler counters (switches, preemptions, utilization, ...).\n");
+	fprintf(stderr, "Option -o <cost> stalls a core <cost> time units whenever it switches jobs.\n");
+	fprintf(stderr, "Option -m <cost> stalls a job <cost> time units when it migrates between cores.\n");
+	fprintf(stderr, "Option -A <window> lets a free core prefer a cache-warm job among the first\n");
+	fprintf(stderr, "<window> queued jobs.\n");
+	fprintf(stderr, "Option -S <speeds> sets per-core speed factors, either a list (-S 2,2,1,1) or a\n");
+	fprintf(stderr, "file with one factor per line.  Cores without a factor run at 1.0.\n");
+	fprintf(stderr, "Option -t <file> writes the schedule as Chrome trace-event JSON, one time unit\n");
+	fprintf(stderr, "per millisecond, for Perfetto (ui.perfetto.dev) or chrome://tracing.\n");
+	fprintf(stderr, "Option -M <name> publishes events and counters to the POSIX shared memory\n");
+	fprintf(stderr, "segment <name> (eg. /scheduler) as the simulation runs; watch it with schedtop.\n");
+	fprintf(stderr, "Option -q prints only the final statistics.\n");
+	fprintf(stderr, "Option -H <schedule> brings cores online or offline as the simulation runs,\n");
+	fprintf(stderr, "eg. -H 100:8,400:2 runs 8 cores from time 100 and 2 from time 400; the highest\n");
+	fprintf(stderr, "numbered cores go offline first and their jobs return to the scheduler.  Takes\n");
+	fprintf(stderr, "a list or a file of time:cores entries in time order.\n");
+	fprintf(stderr, "Option -K <file> (--checkpoint) saves the whole simulation to <file> every\n");
+	fprintf(stderr, "-I <interval> (--interval) time units, 1000 by default.  Option -r <file>\n");
+	fprintf(stderr, "(--resume) continues from a checkpoint given the same input file and options,\n");
+	fprintf(stderr, "or forks a what-if under another scheme.  A resumed -t trace starts there.\n");
+	fprintf(stderr, "Admission control: option -Q <depth> refuses arrivals while <depth> jobs queue,\n");
+	fprintf(stderr, "-W <wait>[:<priority>] refuses arrivals of <priority> or less urgent whose\n");
+	fprintf(stderr, "estimated wait exceeds <wait>, and -B <priority>:<rate>[:<burst>],... limits the\n");
+	fprintf(stderr, "arrivals of a priority with a token bucket.  Refused jobs are rejected, or with\n");
+	fprintf(stderr, "-D <retry> deferred and offered again <retry> time units later.\n");
+	fprintf(stderr, "Option -U <tenant>:<weight>,... shares the cores between tenants by weight: each\n");
+	fprintf(stderr, "tenant's jobs queue apart under the scheme, and a freed core goes to the tenant\n");
+	fprintf(stderr, "served least for its weight.  Unlisted tenants weigh 1 (Eg: -U 0:1 for equal shares).\n");
+	fprintf(stderr, "Option -R <source> sets the run times sjf, psjf and easy order jobs by: oracle\n");
+	fprintf(stderr, "(the true run time, default), class[:alpha] (exponential average of earlier\n");
+	fprintf(stderr, "jobs of the same class) or estimate[:alpha] (the submitter's estimate, scaled by\n");
+	fprintf(stderr, "the average ratio of run time to estimate); alpha weighs the newest job (0.5).\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Input files hold \"Arrival time\",\"Run time\",\"Priority\" columns and an\n");
+	fprintf(stderr, "optional \"Deadline\" column, relative to arrival (blank for none).\n");
+	fprintf(stderr, "An optional fifth \"Cores\" column runs a job on that many cores at once\n");
+	fprintf(stderr, "(gang scheduling) under fcfs, sjf, pri, edf and easy, which backfills\n");
+	fprintf(stderr, "jobs that do not delay the head of the queue.  Optional \"Class\" and \"Estimate\"\n");
+	fprintf(stderr, "columns follow for -R, then an optional \"Tenant\" column for -U.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Files ending in .swf are streamed as Standard Workload Format traces:\n");
+	fprintf(stderr, "Option -T <seconds> sets the SWF seconds per time unit (default 1).\n");
+	fprintf(stderr, "Option -P <field> takes the priority from an SWF field: queue (default),\n");
+	fprintf(stderr, "partition, user, group or procs.\n");
+	fprintf(stderr, "Option -F <filters> replays only matching jobs, eg. -F status=1,queue=2,maxrun=3600,\n");
+	fprintf(stderr, "limit=100000; any SWF field name, minrun, maxrun, maxprocs and limit are accepted.\n");
+	fprintf(stderr, "SWF jobs run on their allocated processors under the gang schemes, so at most\n");
+	fprintf(stderr, "-c <cores> (see -F maxprocs); other schemes give each job one core.  For -R,\n");
+	fprintf(stderr, "a job's class is its user and its estimate the requested time; for -U, its tenant\n");
+	fprintf(stderr, "is its group.\n");
 }
 
-int set_active_job(int job_id, int core_id, simulator_job_list_t *jobs, int active_jobs)
+/*
+ * Reads per-core speed factors from spec, either a comma separated list or the
+ * name of a file holding one factor per line ('#' starts a comment).  Returns 0
+ * if the file cannot be read, a factor is not a positive number or there are
+ * more factors than cores.
+ */
+int load_core_speeds(char *spec, float *speeds, int cores)
 {
-	int i;
-	for (i = 0; i < active_jobs; i++)
+	char line[1024 + 1];
+	char *text = spec, *tok;
+	int n = 0;
+	FILE *file = NULL;
+
+	if (!isdigit((unsigned char)spec[0]) && spec[0] != '.')
 	{
-		if (jobs[i].job_id == job_id && jobs[i].arrived)
+		file = fopen(spec, "r");
+		if (file == NULL)
 		{
-			jobs[i].core_id = core_id;
-			return 1;
+			fprintf(stderr, "Unable to open core description file \"%s\".\n", spec);
+			return 0;
 		}
 	}
 
+	do
+	{
+		if (file != NULL)
+		{
+			if (fgets(line, 1024, file) == NULL)
+				break;
+			text = line;
+			if (strchr(text, '#') != NULL)
+				*strchr(text, '#') = '\0';
+		}
+
+		for (tok = strtok(text, ", \t\r\n"); tok != NULL; tok = strtok(NULL, ", \t\r\n"))
+		{
+			if (atof(tok) <= 0)
+			{
+				fprintf(stderr, "Core speed factors must be positive numbers (got \"%s\").\n", tok);
+				if (file != NULL)
+					fclose(file);
+				return 0;
+			}
+
+			if (n == cores)
+			{
+				fprintf(stderr, "Too many core speed factors, there are only %d core(s).\n", cores);
+				if (file != NULL)
+					fclose(file);
+				return 0;
+			}
+			speeds[n++] = atof(tok);
+		}
+	} while (file != NULL);
+
+	if (file != NULL)
+		fclose(file);
+	return 1;
+}
+
+/*
+ * Core-count schedule (-H).  At each entry's time the cores online are brought
+ * to its count one core at a time, the highest numbered going offline first.
+ */
+typedef struct _hotplug_t
+{
+	int at, cores;
+} hotplug_t;
+
+/*
+ * Reads a core-count schedule from spec, either a comma separated list of
+ * time:cores entries or the name of a file holding them ('#' starts a
+ * comment).  Returns the number of entries, or -1 if the file cannot be read,
+ * an entry is malformed or the times go backwards.
+ */
+int load_core_schedule(char *spec, hotplug_t **plan)
+{
+	char line[1024 + 1];
+	char *text = spec, *tok, *colon;
+	int n = 0, cap = 0;
+	FILE *file = NULL;
+
+	if (!isdigit((unsigned char)spec[0]))
+	{
+		file = fopen(spec, "r");
+		if (file == NULL)
+		{
+			fprintf(stderr, "Unable to open core schedule file \"%s\".\n", spec);
+			return -1;
+		}
+	}
+
+	do
+	{
+		if (file != NULL)
+		{
+			if (fgets(line, 1024, file) == NULL)
+				break;
+			text = line;
+			if (strchr(text, '#') != NULL)
+				*strchr(text, '#') = '\0';
+		}
+
+		for (tok = strtok(text, ", \t\r\n"); tok != NULL; tok = strtok(NULL, ", \t\r\n"))
+		{
+			colon = strchr(tok, ':');
+			if (colon == NULL || !isdigit((unsigned char)tok[0]) || atoi(colon + 1) <= 0
+					|| (n > 0 && atoi(tok) < (*plan)[n - 1].at))
+			{
+				fprintf(stderr, "Core schedule entries are time:cores in time order, with at least one core (got \"%s\").\n", tok);
+				if (file != NULL)
+					fclose(file);
+				return -1;
+			}
+
+			if (n == cap)
+			{
+				cap = (cap == 0) ? 16 : cap * 2;
+				*plan = realloc(*plan, cap * sizeof(hotplug_t));
+			}
+			(*plan)[n].at = atoi(tok);
+			(*plan)[n].cores = atoi(colon + 1);
+			n++;
+		}
+	} while (file != NULL);
+
+	if (file != NULL)
+		fclose(file);
+	return n;
+}
+
+/*
+ * Standard Workload Format (SWF) traces, as published by the Parallel Workloads
+ * Archive, are streamed instead of loaded: SWF jobs are sorted by submit time,
+ * so each one is read only when the clock reaches it, and the jobs array holds
+ * just the jobs in the system.  SWF times are in seconds; they are divided by
+ * swf_scale (run times rounding up to at least one unit) and shifted so the
+ * first job arrives at time 0.  Jobs which never ran (run time 0 or unknown)
+ * are skipped.
+ */
+#define SWF_FIELDS	18
+
+enum { SWF_JOB = 0, SWF_SUBMIT, SWF_WAIT, SWF_RUN, SWF_PROCS, SWF_CPU, SWF_MEM, SWF_REQ_PROCS, SWF_REQ_TIME,
+	SWF_REQ_MEM, SWF_STATUS, SWF_USER, SWF_GROUP, SWF_EXEC, SWF_QUEUE, SWF_PARTITION, SWF_PRECEDING, SWF_THINK };
+
+FILE *swf_file = NULL;
+int swf_scale = 1;
+int swf_priority = SWF_QUEUE;		// Field used as the job priority
+long long swf_want[SWF_FIELDS];		// Required value of each field, -2 for any
+long long swf_min_run = 0, swf_max_run = -1, swf_max_procs = -1, swf_limit = -1;
+long long swf_t0 = -1, swf_n = 0;
+
+int swf_field(const char *name)
+{
+	const char *names[] = { "job", "submit", "wait", "run", "procs", "cpu", "mem", "reqprocs", "reqtime",
+		"reqmem", "status", "user", "group", "exec", "queue", "partition", "preceding", "think" };
+	int i;
+	for (i = 0; i < SWF_FIELDS; i++)
+		if (strcasecmp(name, names[i]) == 0)
+			return i;
+	return -1;
+}
+
+/*
+ * Parses a comma separated filter list: field=value pairs select jobs whose
+ * SWF field has that value (eg. status=1,queue=2), and minrun, maxrun (in
+ * seconds), maxprocs and limit (the number of jobs to replay) bound the rest.
+ * Returns 0 on an unknown key.
+ */
+int swf_filters(char *spec)
+{
+	char *tok, *eq;
+
+	for (tok = strtok(spec, ","); tok != NULL; tok = strtok(NULL, ","))
+	{
+		eq = strchr(tok, '=');
+		if (eq == NULL)
+			return 0;
+		*eq++ = '\0';
+
+		if (strcasecmp(tok, "minrun") == 0) { swf_min_run = atoll(eq); }
+		else if (strcasecmp(tok, "maxrun") == 0) { swf_max_run = atoll(eq); }
+		else if (strcasecmp(tok, "maxprocs") == 0) { swf_max_procs = atoll(eq); }
+		else if (strcasecmp(tok, "limit") == 0) { swf_limit = atoll(eq); }
+		else if (swf_field(tok) != -1) { swf_want[swf_field(tok)] = atoll(eq); }
+		else
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Reads the next job passing the filters into job, returning 0 at the end of
+ * the trace.  The caller assigns the job id.
+ */
+int swf_read_job(simulator_job_list_t *job)
+{
+	char line[1024 + 1], *p, *end;
+	long long f[SWF_FIELDS];
+	int i;
+
+	if (swf_limit != -1 && swf_n >= swf_limit)
+		return 0;
+
+	while (fgets(line, 1024, swf_file) != NULL)
+	{
+		// Header comments start with ';'
+		p = line + strspn(line, " \t");
+		if (*p == ';' || *p == '\n' || *p == '\r' || *p == '\0')
+			continue;
+
+		for (i = 0; i < SWF_FIELDS; i++, p = end)
+		{
+			f[i] = (long long)strtod(p, &end);
+			if (end == p)
+				break;
+		}
+		if (i < SWF_FIELDS)
+			continue;
+
+		for (i = 0; i < SWF_FIELDS; i++)
+			if (swf_want[i] != -2 && f[i] != swf_want[i])
+				break;
+		if (i < SWF_FIELDS || f[SWF_RUN] <= 0 || f[SWF_RUN] < swf_min_run)
+			continue;
+		if ((swf_max_run != -1 && f[SWF_RUN] > swf_max_run) || (swf_max_procs != -1 && f[SWF_PROCS] > swf_max_procs))
+			continue;
+
+		if (swf_t0 == -1)
+			swf_t0 = f[SWF_SUBMIT];
+
+		job->arrival_time = (int)((f[SWF_SUBMIT] - swf_t0) / swf_scale);
+		job->run_time = (int)((f[SWF_RUN] + swf_scale - 1) / swf_scale);
+		job->work = (long long)job->run_time * SPEED_UNIT;
+		job->priority = (int)f[swf_priority];
+		job->deadline = -1;
+		job->width = (f[SWF_PROCS] > 1) ? (int)f[SWF_PROCS] : 1;
+		job->job_class = (f[SWF_USER] >= 0) ? (int)f[SWF_USER] : -1;
+		job->estimate = (f[SWF_REQ_TIME] > 0) ? (int)((f[SWF_REQ_TIME] + swf_scale - 1) / swf_scale) : -1;
+		job->tenant = (f[SWF_GROUP] >= 0 && f[SWF_GROUP] < TENANTS_MAX) ? (int)f[SWF_GROUP] : -1;
+		job->core_id = -1;
+		job->arrived = 0;
+		job->last_core = -1;
+		job->stall = 0;
+		swf_n++;
+		return 1;
+	}
 	return 0;
 }
 
+/*
+ * Drops the job in slot from the jobs array, moving the last job into its
+ * place.  Returns the new number of active jobs.
+ */
+int retire_slot(simulator_job_list_t *jobs, int slot, int active_jobs)
+{
+	int c, k;
+
+	job_slot[jobs[slot].job_id] = -1;
+	if (slot != active_jobs - 1)
+	{
+		memcpy(&jobs[slot], &jobs[active_jobs - 1], sizeof(simulator_job_list_t));
+		job_slot[jobs[slot].job_id] = slot;
+		for (c = jobs[slot].core_id, k = jobs[slot].width; c != -1 && k > 0; c++)
+		{
+			if (core_job[c] == active_jobs - 1)
+			{
+				core_job[c] = slot;
+				k--;
+			}
+		}
+	}
+	return active_jobs - 1;
+}
+
+void dispatch_job(simulator_job_list_t *jobs, int slot, int core_id)
+{
+	simulator_job_list_t *job = &jobs[slot];
+	core_job[core_id] = slot;
+
+	job->stall = 0;
+	if (core_last_job[core_id] != job->job_id)
+		job->stall += switch_cost;
+	if (job->last_core != -1 && job->last_core != core_id)
+		job->stall += migrate_cost;
+
+	core_last_job[core_id] = job->job_id;
+	job->last_core = core_id;
+	job->core_id = core_id;
+}
+
+int set_active_job(int job_id, int core_id, simulator_job_list_t *jobs, int active_jobs)
+{
+	if (job_id < 0 || job_id >= job_total)
+		return 0;
+
+	int i = job_slot[job_id];
+	if (i < 0 || i >= active_jobs || !jobs[i].arrived)
+		return 0;
+
+	dispatch_job(jobs, i, core_id);
+	return 1;
+}
+
+/*
+ * Gang scheduling, under EASY or once a job has a "Cores" count above one.  A
+ * gang job holds all its cores from start to finish and is led by the lowest:
+ * jobs[].core_id names it, its speed paces the job and any switch overhead is
+ * paid there.  One scheduler call may start several jobs.
+ */
+int gang = 0;
+int *gang_started, *gang_cores;
+
+int gang_capable()
+{
+	return policy->should_preempt == NULL && policy->on_quantum == NULL;
+}
+
+/*
+ * Dispatches every job the last scheduler call started, returning how many or
+ * -1 if the scheduler started an invalid job or put it on a busy core.
+ */
+int dispatch_started(simulator_job_list_t *jobs, int active_jobs, int time)
+{
+	int n = scheduler_started_jobs(gang_started), k, m, c;
+
+	for (k = 0; k < n; k++)
+	{
+		int job_id = gang_started[k];
+		m = scheduler_job_cores(job_id, gang_cores);
+		for (c = 0; c < m; c++)
+			if (core_job[gang_cores[c]] != -1)
+				return -1;
+		if (m == 0 || !set_active_job(job_id, gang_cores[0], jobs, active_jobs) || m != jobs[job_slot[job_id]].width)
+			return -1;
+
+		for (c = 1; c < m; c++)
+		{
+			core_job[gang_cores[c]] = job_slot[job_id];
+			core_last_job[gang_cores[c]] = job_id;
+		}
+		for (c = 0; c < m; c++)
+			trace_run(gang_cores[c], job_id, jobs[job_slot[job_id]].stall, time);
+		telemetry_event(telemetry, TEL_DISPATCH, time, job_id, gang_cores[0]);
+	}
+	return n;
+}
+
+void print_started_jobs(int n)
+{
+	int k, m, c;
+	for (k = 0; k < n; k++)
+	{
+		m = scheduler_job_cores(gang_started[k], gang_cores);
+		printf("Job %d is now running on core(s)", gang_started[k]);
+		for (c = 0; c < m; c++)
+			printf(" %d", gang_cores[c]);
+		printf(".\n");
+	}
+}
+
+/*
+ * Checkpoints (-K <file>) hold the whole simulation at the start of a time
+ * unit: this header (cores counting every core -H may bring online), the simulator's arrays and timing diagram, then the
+ * scheduler's own state.  Resuming from one (--resume <file>) with the same
+ * input file and options continues exactly as the original run did from that
+ * time unit on; changing the scheme instead forks a what-if from that point.
+ * A checkpoint is written to <file>.tmp and renamed, so a crash mid-write
+ * leaves the previous one intact.
+ */
+#define SNAPSHOT_MAGIC	"SIMSNAP4"
+
+typedef struct _snapshot_t
+{
+	int time, cores, online, scheme, quantum;
+	int active_jobs, jobs_alive, job_total, arrival_ct, arrival_next;
+	int gang, swf_more, expiry_n, finish_n, retry_n;
+	long long overhead_time, swf_offset, swf_t0, swf_n;
+} snapshot_t;
+
+int save_snapshot(const char *name, snapshot_t *snap, simulator_job_list_t *jobs, arrival_t *arrivals,
+		char **diagram, simulator_job_list_t *swf_next)
+{
+	char tmp_name[strlen(name) + 5];
+	int i, len;
+
+	snap->job_total = job_total;
+	snap->expiry_n = expiry_n;
+	snap->finish_n = finish_n;
+	snap->retry_n = retry_n;
+	snap->overhead_time = overhead_time;
+	snap->swf_offset = (swf_file != NULL) ? ftell(swf_file) : -1;
+	snap->swf_t0 = swf_t0;
+	snap->swf_n = swf_n;
+
+	sprintf(tmp_name, "%s.tmp", name);
+	FILE *file = fopen(tmp_name, "wb");
+	if (file == NULL)
+		return 0;
+
+	fwrite(SNAPSHOT_MAGIC, 1, 8, file);
+	fwrite(snap, sizeof(snapshot_t), 1, file);
+	fwrite(swf_next, sizeof(simulator_job_list_t), 1, file);
+	fwrite(jobs, sizeof(simulator_job_list_t), snap->active_jobs, file);
+	fwrite(job_slot, sizeof(int), snap->job_total, file);
+	if (snap->arrival_ct)
+		fwrite(arrivals, sizeof(arrival_t), snap->arrival_ct, file);
+	fwrite(core_last_job, sizeof(int), snap->cores, file);
+	fwrite(core_job, sizeof(int), snap->cores, file);
+	fwrite(expiry_seq, sizeof(int), snap->cores, file);
+	if (snap->expiry_n)
+		fwrite(expiry_heap, sizeof(expiry_t), snap->expiry_n, file);
+	fwrite(finish_heap, sizeof(int), snap->finish_n, file);
+	if (snap->retry_n)
+		fwrite(retry_heap, sizeof(arrival_t), snap->retry_n, file);
+	for (i = 0; i < snap->cores; i++)
+	{
+		len = strlen(diagram[i]);
+		fwrite(&len, sizeof(int), 1, file);
+		fwrite(diagram[i], 1, len, file);
+	}
+
+	if (!scheduler_save(file) || fclose(file) != 0)
+		return 0;
+	return rename(tmp_name, name) == 0;
+}
+
+/*
+ * Reads a checkpoint over the freshly initialised simulation, replacing the
+ * jobs, job_slot, arrivals and diagram arrays.  The header fields are left in
+ * snap; returns 0 if the file is unreadable or was taken on another machine
+ * size or trace.
+ */
+int load_snapshot(const char *name, snapshot_t *snap, simulator_job_list_t **jobs, int *jobs_ct, arrival_t **arrivals,
+		char **diagram, int *diagram_size, simulator_job_list_t *swf_next)
+{
+	char magic[8];
+	int i, len, ok, cores = snap->cores, arrival_ct = snap->arrival_ct;
+
+	FILE *file = fopen(name, "rb");
+	if (file == NULL)
+		return 0;
+
+	ok = fread(magic, 1, 8, file) == 8 && memcmp(magic, SNAPSHOT_MAGIC, 8) == 0
+			&& fread(snap, sizeof(snapshot_t), 1, file) == 1
+			&& snap->cores == cores && snap->online >= 1 && snap->online <= cores && snap->active_jobs >= 0 && snap->job_total >= snap->active_jobs
+			&& (swf_file != NULL || snap->arrival_ct == arrival_ct)
+			&& snap->expiry_n >= 0 && snap->finish_n >= 0 && snap->finish_n <= cores && snap->retry_n >= 0;
+	if (!ok)
+	{
+		fclose(file);
+		return 0;
+	}
+
+	*jobs_ct = (snap->active_jobs > 10) ? snap->active_jobs : 10;
+	*jobs = realloc(*jobs, *jobs_ct * sizeof(simulator_job_list_t));
+	job_slot = realloc(job_slot, (snap->job_total + 1) * sizeof(int));
+	*arrivals = realloc(*arrivals, (snap->arrival_ct + 1) * sizeof(arrival_t));
+	expiry_cap = snap->expiry_n + 16;
+	expiry_heap = realloc(expiry_heap, expiry_cap * sizeof(expiry_t));
+	retry_cap = snap->retry_n + 16;
+	retry_heap = realloc(retry_heap, retry_cap * sizeof(arrival_t));
+
+	ok = fread(swf_next, sizeof(simulator_job_list_t), 1, file) == 1
+			&& (int)fread(*jobs, sizeof(simulator_job_list_t), snap->active_jobs, file) == snap->active_jobs
+			&& (int)fread(job_slot, sizeof(int), snap->job_total, file) == snap->job_total
+			&& (int)fread(*arrivals, sizeof(arrival_t), snap->arrival_ct, file) == snap->arrival_ct
+			&& (int)fread(core_last_job, sizeof(int), cores, file) == cores
+			&& (int)fread(core_job, sizeof(int), cores, file) == cores
+			&& (int)fread(expiry_seq, sizeof(int), cores, file) == cores
+			&& (int)fread(expiry_heap, sizeof(expiry_t), snap->expiry_n, file) == snap->expiry_n
+			&& (int)fread(finish_heap, sizeof(int), snap->finish_n, file) == snap->finish_n
+			&& (int)fread(retry_heap, sizeof(arrival_t), snap->retry_n, file) == snap->retry_n;
+
+	for (i = 0; ok && i < cores; i++)
+	{
+		ok = fread(&len, sizeof(int), 1, file) == 1 && len >= 0;
+		if (!ok)
+			break;
+
+		while (len >= *diagram_size)
+			*diagram_size *= 2;
+		diagram[i] = realloc(diagram[i], *diagram_size + 1);
+		ok = (int)fread(diagram[i], 1, len, file) == len;
+		diagram[i][len] = '\0';
+	}
+	for (i = 0; i < cores; i++)
+		diagram[i] = realloc(diagram[i], *diagram_size + 1);
+
+	ok = ok && scheduler_restore(file);
+	fclose(file);
+	if (!ok)
+		return 0;
+
+	job_total = snap->job_total;
+	expiry_n = snap->expiry_n;
+	finish_n = snap->finish_n;
+	retry_n = snap->retry_n;
+	overhead_time = snap->overhead_time;
+	swf_t0 = snap->swf_t0;
+	swf_n = snap->swf_n;
+	return swf_file == NULL || fseek(swf_file, snap->swf_offset, SEEK_SET) == 0;
+}
+
 void print_available_jobs(simulator_job_list_t *jobs, int active_jobs)
 {
 	printf("Active jobs are: ");
@@ -77,13 +1113,31 @@ void print_available_cores(int cores)
 int main(int argc, char **argv)
 {
 	int c;
-	int cores = 0, scheme = -1, quantum = 0;
-	char *file_name;
+	int cores = 0, scheme = -1, quantum = 0, age = 0, percentiles = 0, verbose = 0, affinity = 0, quiet = 0;
+	int prediction = PREDICT_ORACLE;
+	float alpha = 0.5f;
+	char *checkpoint_name = NULL, *resume_name = NULL;
+	int checkpoint_every = 1000;
+	struct option long_options[] = {
+		{ "checkpoint", required_argument, NULL, 'K' },
+		{ "interval", required_argument, NULL, 'I' },
+		{ "resume", required_argument, NULL, 'r' },
+		{ NULL, 0, NULL, 0 }
+	};
+	char *file_name, *speed_spec = NULL, *trace_name = NULL, *telemetry_name = NULL, *hotplug_spec = NULL;
+	int queue_limit = 0, wait_limit = -1, wait_priority = 0, admission = 0;
+	rate_limit_t *rate_limits = NULL;
+	int rate_limit_n = 0;
+	tenant_weight_t *weights = NULL;
+	int weight_n = 0;
+
+	for (c = 0; c < SWF_FIELDS; c++)
+		swf_want[c] = -2;
 
 	/*
 	 * Parse command line options.
 	 */
-	while ((c = getopt(argc, argv, "c:s:")) != -1)
+	while ((c = getopt_long(argc, argv, "c:s:a:pvo:m:A:S:t:M:qH:Q:W:B:D:U:T:P:F:R:K:I:r:", long_options, NULL)) != -1)
 	{
 		switch (c)
 		{
@@ -104,6 +1158,31 @@ int main(int argc, char **argv)
 				else if (strcasecmp(optarg, "PSJF") == 0) { scheme = PSJF; }
 				else if (strcasecmp(optarg, "PRI") == 0) { scheme = PRI; }
 				else if (strcasecmp(optarg, "PPRI") == 0) { scheme = PPRI; }
+				else if (strcasecmp(optarg, "EDF") == 0) { scheme = EDF; }
+				else if (strcasecmp(optarg, "PEDF") == 0) { scheme = PEDF; }
+				else if (strcasecmp(optarg, "EASY") == 0) { scheme = EASY; }
+				else if (strncasecmp(optarg, "CFS", 3) == 0)
+				{
+					scheme = CFS;
+					quantum = (optarg[3] == '\0') ? 6 : atoi(optarg + 3);
+
+					if (quantum <= 0)
+					{
+						fprintf(stderr, "Option -s <scheme> requires a positive number for the target latency of CFS. (Eg: -s CFS6)\n");
+						print_usage(argv[0]);
+						return 1;
+					}
+				}
+				else if (strncasecmp(optarg, "PLUGIN:", 7) == 0)
+				{
+					scheme = PLUGIN;
+					if ((policy = load_plugin(optarg, &quantum)) == NULL)
+					{
+						fprintf(stderr, "Option -s plugin:<path> requires a shared object exporting a policy. (Eg: -s plugin:./plugins/lcfs.so)\n");
+						print_usage(argv[0]);
+						return 1;
+					}
+				}
 				else if (strncasecmp(optarg, "RR", 2) == 0)
 				{
 					scheme = RR;
@@ -118,6 +1197,199 @@ int main(int argc, char **argv)
 				}
 				break;
 
+			case 'a':
+				age = atoi(optarg);
+
+				if (age <= 0)
+				{
+					fprintf(stderr, "Option -a <age> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'p':
+				percentiles = 1;
+				break;
+
+			case 'v':
+				verbose = 1;
+				break;
+
+			case 'o':
+			case 'm':
+				if (atoi(optarg) < 0)
+				{
+					fprintf(stderr, "Option -%c <cost> requires a non-negative number.\n", c);
+					print_usage(argv[0]);
+					return 1;
+				}
+
+				if (c == 'o')
+					switch_cost = atoi(optarg);
+				else
+					migrate_cost = atoi(optarg);
+				break;
+
+			case 'A':
+				affinity = atoi(optarg);
+				break;
+
+			case 'S':
+				speed_spec = optarg;
+				break;
+
+			case 't':
+				trace_name = optarg;
+				break;
+
+			case 'M':
+				telemetry_name = optarg;
+				break;
+
+			case 'q':
+				quiet = 1;
+				break;
+
+			case 'H':
+				hotplug_spec = optarg;
+				break;
+
+			case 'Q':
+				queue_limit = atoi(optarg);
+				admission = 1;
+
+				if (queue_limit <= 0)
+				{
+					fprintf(stderr, "Option -Q <depth> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'W':
+				wait_limit = atoi(optarg);
+				wait_priority = (strchr(optarg, ':') != NULL) ? atoi(strchr(optarg, ':') + 1) : INT_MIN;
+				admission = 1;
+
+				if (wait_limit < 0 || !isdigit((unsigned char)optarg[0]))
+				{
+					fprintf(stderr, "Option -W <wait>[:<priority>] requires a non-negative wait. (Eg: -W 50:2)\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'B':
+				rate_limit_n = load_rate_limits(optarg, &rate_limits);
+				admission = 1;
+
+				if (rate_limit_n < 0)
+				{
+					fprintf(stderr, "Option -B <limits> requires priority:rate[:burst] entries with a positive rate. (Eg: -B 3:0.5:4)\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'U':
+				weight_n = load_tenant_weights(optarg, &weights);
+
+				if (weight_n < 0)
+				{
+					fprintf(stderr, "Option -U <weights> requires tenant:weight entries with a tenant below %d and a positive weight. (Eg: -U 0:3,1:1)\n", TENANTS_MAX);
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'D':
+				retry_delay = atoi(optarg);
+
+				if (retry_delay <= 0)
+				{
+					fprintf(stderr, "Option -D <retry> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'K':
+				checkpoint_name = optarg;
+				break;
+
+			case 'I':
+				checkpoint_every = atoi(optarg);
+
+				if (checkpoint_every <= 0)
+				{
+					fprintf(stderr, "Option -I <interval> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'r':
+				resume_name = optarg;
+				break;
+
+			case 'R':
+				if (strcasecmp(optarg, "oracle") == 0) { prediction = PREDICT_ORACLE; }
+				else if (strncasecmp(optarg, "class", 5) == 0 && (optarg[5] == '\0' || optarg[5] == ':')) { prediction = PREDICT_CLASS; }
+				else if (strncasecmp(optarg, "estimate", 8) == 0 && (optarg[8] == '\0' || optarg[8] == ':')) { prediction = PREDICT_ESTIMATE; }
+				else
+				{
+					fprintf(stderr, "Option -R <source> requires oracle, class[:alpha] or estimate[:alpha].\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+
+				if (strchr(optarg, ':') != NULL)
+				{
+					alpha = atof(strchr(optarg, ':') + 1);
+					if (alpha <= 0 || alpha > 1)
+					{
+						fprintf(stderr, "Option -R <source> requires an alpha in (0,1]. (Eg: -R class:0.5)\n");
+						print_usage(argv[0]);
+						return 1;
+					}
+				}
+				break;
+
+			case 'T':
+				swf_scale = atoi(optarg);
+
+				if (swf_scale <= 0)
+				{
+					fprintf(stderr, "Option -T <seconds> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'P':
+				swf_priority = swf_field(optarg);
+				if (strcasecmp(optarg, "procs") == 0)
+					swf_priority = SWF_PROCS;
+
+				if (swf_priority != SWF_QUEUE && swf_priority != SWF_PARTITION && swf_priority != SWF_USER
+						&& swf_priority != SWF_GROUP && swf_priority != SWF_PROCS)
+				{
+					fprintf(stderr, "Option -P <field> requires queue, partition, user, group or procs.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'F':
+				if (!swf_filters(optarg))
+				{
+					fprintf(stderr, "Option -F <filters> requires field=value pairs.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
 			case '?':
 				print_usage(argv[0]);
 				return 1;
@@ -141,6 +1413,8 @@ int main(int argc, char **argv)
 		print_usage(argv[0]);
 		return 1;
 	}
+	if (scheme != PLUGIN)
+		policy = scheduler_builtin_policy(scheme);
 
 	if (optind == argc - 1)
 		file_name = argv[optind];
@@ -165,15 +1439,34 @@ int main(int argc, char **argv)
 
 	int job_id = 0;
 	int jobs_ct = 10;
+	int has_deadlines = 0, has_gang = 0;
 	simulator_job_list_t* jobs = malloc(jobs_ct * sizeof(simulator_job_list_t));
 
+	// SWF traces are read as the simulation reaches each job, keeping one job of lookahead
+	simulator_job_list_t swf_next;
+	int swf_more = 0;
+	size_t name_len = strlen(file_name);
+	if (name_len > 4 && strcasecmp(file_name + name_len - 4, ".swf") == 0)
+	{
+		swf_file = file;
+		swf_more = swf_read_job(&swf_next);
+	}
+
 	char line[1024 + 1];
-	fgets(line, 1024, file);  // Ignore the first (header) line
-	while (fgets(line, 1024, file) != NULL)
+	if (swf_file == NULL)
+		fgets(line, 1024, file);  // Ignore the first (header) line
+	while (swf_file == NULL && fgets(line, 1024, file) != NULL)
 	{
-		char *arrival_time = strtok(line, ",");
-		char *run_time = strtok(NULL, ",");
-		char *priority = strtok(NULL, ",");
+		// Empty fields are kept, a blank deadline may precede a core count
+		char *rest = line;
+		char *arrival_time = strsep(&rest, ",");
+		char *run_time = strsep(&rest, ",");
+		char *priority = strsep(&rest, ",");
+		char *deadline = strsep(&rest, ",");
+		char *width = strsep(&rest, ",");
+		char *job_class = strsep(&rest, ",");
+		char *estimate = strsep(&rest, ",");
+		char *tenant = strsep(&rest, ",");
 
 		if (arrival_time != NULL && run_time != NULL && priority != NULL)
 		{
@@ -192,9 +1485,40 @@ int main(int argc, char **argv)
 			jobs[job_id].job_id = job_id;
 			jobs[job_id].arrival_time = atoi(arrival_time);
 			jobs[job_id].run_time = atoi(run_time);
+			jobs[job_id].work = (long long)jobs[job_id].run_time * SPEED_UNIT;
 			jobs[job_id].priority = atoi(priority);
+			jobs[job_id].deadline = -1;
+			if (deadline != NULL && strspn(deadline, " \t\r\n") != strlen(deadline))
+			{
+				jobs[job_id].deadline = atoi(deadline);
+				has_deadlines = 1;
+			}
+			jobs[job_id].width = 1;
+			if (width != NULL && atoi(width) > 1)
+			{
+				jobs[job_id].width = atoi(width);
+				has_gang = 1;
+			}
+			jobs[job_id].job_class = -1;
+			if (job_class != NULL && strspn(job_class, " \t\r\n") != strlen(job_class))
+				jobs[job_id].job_class = atoi(job_class);
+			jobs[job_id].estimate = -1;
+			if (estimate != NULL && atoi(estimate) > 0)
+				jobs[job_id].estimate = atoi(estimate);
+			jobs[job_id].tenant = -1;
+			if (tenant != NULL && strspn(tenant, " \t\r\n") != strlen(tenant))
+			{
+				jobs[job_id].tenant = atoi(tenant);
+				if (jobs[job_id].tenant < 0 || jobs[job_id].tenant >= TENANTS_MAX)
+				{
+					fprintf(stderr, "Job %d names tenant %d, tenants run from 0 to %d.\n", job_id, jobs[job_id].tenant, TENANTS_MAX - 1);
+					return 2;
+				}
+			}
 			jobs[job_id].core_id = -1;
 			jobs[job_id].arrived = 0;
+			jobs[job_id].last_core = -1;
+			jobs[job_id].stall = 0;
 
 			job_id++;
 		}
@@ -205,67 +1529,299 @@ int main(int argc, char **argv)
 		}
 	}
 
-	fclose(file);
+	if (swf_file == NULL)
+		fclose(file);
+
+	// Every array is sized for the most cores the schedule brings online
+	hotplug_t *plan = NULL;
+	int plan_n = 0, plan_next = 0, max_cores = cores;
+	if (hotplug_spec != NULL && (plan_n = load_core_schedule(hotplug_spec, &plan)) < 0)
+		return 1;
+	for (c = 0; c < plan_n; c++)
+		if (plan[c].cores > max_cores)
+			max_cores = plan[c].cores;
+
+	if (has_gang && !gang_capable())
+	{
+		fprintf(stderr, "Jobs on more than one core need a gang scheme: fcfs, sjf, pri, edf, easy or a plugin which neither preempts nor time-slices.\n");
+		return 1;
+	}
+	for (c = 0; c < job_id; c++)
+	{
+		if (jobs[c].width > max_cores)
+		{
+			fprintf(stderr, "Job %d needs %d cores, only %d are available.\n", c, jobs[c].width, max_cores);
+			return 1;
+		}
+	}
+	// Like the scheduler, gang schedule from the first job on several cores on
+	if (scheme == EASY)
+		gang = 1;
+
+
+	int time = 0, i, j, k;
+
+	float *speeds = malloc(max_cores * sizeof(float));
+	core_speed = malloc(max_cores * sizeof(int));
+	for (i = 0; i < max_cores; i++)
+		speeds[i] = 1.0f;
+
+	if (speed_spec != NULL && !load_core_speeds(speed_spec, speeds, max_cores))
+		return 1;
 
 
 	/*
 	 * Run the simulation.
 	 */
 
-	printf("Loaded %d core(s) and %d job(s) using ", cores, job_id);
+	if (swf_file != NULL)
+		printf("Streaming jobs from SWF trace \"%s\" on %d core(s) using ", file_name, cores);
+	else
+		printf("Loaded %d core(s) and %d job(s) using ", cores, job_id);
 	if (scheme == FCFS) { printf("First Come First Served (FCFS)"); }
 	else if (scheme == SJF) { printf("Non-preemptive Shortest Job First (SJF)"); }
 	else if (scheme == PSJF) { printf("Preemptive Shortest Job First (PSJF)"); }
 	else if (scheme == PRI) { printf("Non-preemptive Priority (PRI)"); }
 	else if (scheme == PPRI) { printf("Preemptive Priority (PPRI)"); }
 	else if (scheme == RR) { printf("Round Robin (RR) with a quantum of %d", quantum); }
+	else if (scheme == CFS) { printf("Completely Fair Scheduler (CFS) with a target latency of %d", quantum); }
+	else if (scheme == EDF) { printf("Non-preemptive Earliest Deadline First (EDF)"); }
+	else if (scheme == PEDF) { printf("Preemptive Earliest Deadline First (PEDF)"); }
+	else if (scheme == EASY) { printf("First Come First Served with EASY backfilling (EASY)"); }
+	else if (scheme == PLUGIN && quantum > 0) { printf("the \"%s\" policy plugin with a quantum of %d", policy->name, quantum); }
+	else if (scheme == PLUGIN) { printf("the \"%s\" policy plugin", policy->name); }
 	printf(" scheduling...\n\n");
 
-	scheduler_start_up(cores, scheme);
+	if (speed_spec != NULL)
+	{
+		printf("Core speeds:");
+		for (i = 0; i < max_cores; i++)
+			printf(" %.2f", speeds[i]);
+		printf("\n\n");
+	}
+
+	if (plan_n > 0)
+	{
+		printf("Core schedule (time:cores):");
+		for (i = 0; i < plan_n; i++)
+			printf(" %d:%d", plan[i].at, plan[i].cores);
+		printf("\n\n");
+	}
+
+	if (scheme == PLUGIN)
+		scheduler_start_up_policy(cores, policy);
+	else
+		scheduler_start_up(cores, scheme);
+	if (max_cores > cores)
+		scheduler_set_max_cores(max_cores);
+	if (scheme == CFS)
+		scheduler_set_latency(quantum);
+	if (age > 0)
+		scheduler_set_aging(age);
+	if (affinity > 0)
+		scheduler_set_affinity(affinity);
+	if (switch_cost > 0 || migrate_cost > 0)
+		scheduler_set_switch_cost(switch_cost, migrate_cost);
+	if (prediction != PREDICT_ORACLE)
+		scheduler_set_prediction(prediction, alpha);
+	if (queue_limit > 0)
+		scheduler_set_queue_limit(queue_limit);
+	if (wait_limit >= 0)
+		scheduler_set_wait_limit(wait_limit, wait_priority);
+	for (i = 0; i < rate_limit_n; i++)
+		scheduler_set_rate_limit(rate_limits[i].priority, rate_limits[i].rate, rate_limits[i].burst);
+	if (retry_delay > 0)
+		scheduler_set_admission(ADMIT_DEFER);
+	for (i = 0; i < weight_n; i++)
+		scheduler_set_tenant_weight(weights[i].tenant, weights[i].weight);
+
+	// Let the scheduler size a bucket queue to the trace's priorities (unknown up front for SWF)
+	if (job_id > 0)
+	{
+		int lo = jobs[0].priority, hi = jobs[0].priority;
+		for (i = 1; i < job_id; i++)
+		{
+			if (jobs[i].priority < lo) { lo = jobs[i].priority; }
+			if (jobs[i].priority > hi) { hi = jobs[i].priority; }
+		}
+		scheduler_set_priority_range(lo, hi);
+	}
+
+	for (i = 0; i < max_cores; i++)
+	{
+		scheduler_set_core_speed(i, speeds[i]);
+		core_speed[i] = (int)(speeds[i] * SPEED_UNIT + 0.5f);
+		if (core_speed[i] < 1)
+			core_speed[i] = 1;
+	}
+	free(speeds);
 
 
-	int time = 0, i, j;
 	int active_jobs = job_id, jobs_alive = 0;
 
-	int *quantum_clock = malloc(cores * sizeof(int));
-	char **core_timing_diagram = malloc(cores * sizeof(char *));
+	job_total = job_id;
+	job_slot = malloc((job_total + 1) * sizeof(int));
+	finish_heap = malloc(max_cores * sizeof(int));
+
+	int arrival_next = 0, arrival_ct = job_total;
+	int arriving_ct = job_total + 1, slot_ct = job_total + 1;
+	int *arriving = malloc(arriving_ct * sizeof(int));
+	arrival_t *arrivals = malloc((job_total + 1) * sizeof(arrival_t));
+	for (i = 0; i < job_total; i++)
+	{
+		job_slot[i] = i;
+		arrivals[i].at = jobs[i].arrival_time;
+		arrivals[i].job_id = i;
+	}
+	qsort(arrivals, job_total, sizeof(arrival_t), arrival_compare);
+
+	core_last_job = malloc(max_cores * sizeof(int));
+	core_job = malloc(max_cores * sizeof(int));
+	gang_started = malloc(max_cores * sizeof(int));
+	gang_cores = malloc(max_cores * sizeof(int));
+	expiry_seq = malloc(max_cores * sizeof(int));
+	char **core_timing_diagram = malloc(max_cores * sizeof(char *));
 	int core_timing_diagram_size = 1024;
 
-	for (i = 0; i < cores; i++)
+	for (i = 0; i < max_cores; i++)
 	{
-		quantum_clock[i] = -1;
+		core_last_job[i] = -1;
+		core_job[i] = -1;
+		expiry_seq[i] = 0;
 		core_timing_diagram[i] = malloc(core_timing_diagram_size + 1);
 		core_timing_diagram[i][0] = '\0';
 	}
 
-	while (active_jobs > 0)
+	if (resume_name != NULL)
+	{
+		snapshot_t snap = { 0 };
+		snap.cores = max_cores;
+		snap.arrival_ct = arrival_ct;
+		if (!load_snapshot(resume_name, &snap, &jobs, &jobs_ct, &arrivals, core_timing_diagram, &core_timing_diagram_size, &swf_next))
+		{
+			fprintf(stderr, "Unable to resume from \"%s\", it is unreadable or was saved from another trace or core count.\n", resume_name);
+			return 2;
+		}
+		if (snap.gang && !gang_capable())
+		{
+			fprintf(stderr, "The checkpoint holds jobs on more than one core, which need a gang scheme: fcfs, sjf, pri, edf, easy or a plugin which neither preempts nor time-slices.\n");
+			return 1;
+		}
+
+		time = snap.time;
+		cores = snap.online;
+		active_jobs = snap.active_jobs;
+		jobs_alive = snap.jobs_alive;
+		arrival_next = snap.arrival_next;
+		gang = gang || snap.gang;
+		swf_more = snap.swf_more;
+		slot_ct = job_total + 1;
+
+		// Quanta of another scheme no longer apply, the running jobs start afresh
+		if (snap.scheme != scheme || snap.quantum != quantum)
+		{
+			expiry_n = 0;
+			for (i = 0; i < cores; i++)
+			{
+				expiry_seq[i]++;
+				if (core_job[i] != -1)
+					start_quantum(i, time, jobs[core_job[i]].stall, quantum);
+			}
+		}
+		printf("Resumed from \"%s\" at time %d.\n\n", resume_name, time);
+
+		// Schedule entries up to the checkpoint have been applied, under the schedule given now
+		while (plan_next < plan_n && plan[plan_next].at < time)
+			plan_next++;
+	}
+	int checkpoint_next = (time / checkpoint_every + 1) * checkpoint_every;
+
+	if (trace_name != NULL && !trace_begin(trace_name, max_cores))
+		return 2;
+	if (telemetry_name != NULL && (telemetry = telemetry_create(telemetry_name, max_cores)) == NULL)
+	{
+		fprintf(stderr, "Unable to create shared memory \"%s\".\n", telemetry_name);
+		return 2;
+	}
+	if (plan_n > 0)
+		trace_hotplug(-1, time, 1, cores);
+	for (i = 0; i < cores; i++)
+		if (core_job[i] != -1)
+			trace_run(i, jobs[core_job[i]].job_id, jobs[core_job[i]].stall, time);
+
+	while (active_jobs > 0 || swf_more)
 	{
-		printf("=== [TIME %d] ===\n", time);
+		// With nothing in the system and no diagram to draw, skip ahead to the next arrival
+		if (quiet && active_jobs == 0 && swf_more && swf_next.arrival_time > time)
+		{
+			time = swf_next.arrival_time;
+			if (plan_next < plan_n && plan[plan_next].at < time)
+				time = plan[plan_next].at;
+		}
+
+		if (checkpoint_name != NULL && time >= checkpoint_next)
+		{
+			snapshot_t snap = { time, max_cores, cores, scheme, quantum, active_jobs, jobs_alive, 0, arrival_ct, arrival_next,
+					gang, swf_more, 0, 0, 0, 0, 0, 0, 0 };
+			if (!save_snapshot(checkpoint_name, &snap, jobs, arrivals, core_timing_diagram, &swf_next))
+			{
+				fprintf(stderr, "Unable to write checkpoint \"%s\".\n", checkpoint_name);
+				return 2;
+			}
+			checkpoint_next = (time / checkpoint_every + 1) * checkpoint_every;
+		}
+
+		if (!quiet)
+			printf("=== [TIME %d] ===\n", time);
 
 		/*
 		 * 1. Check if any jobs finished in the last time unit.
 		 */
-		for (i = 0; i < active_jobs; i++)
+		while ((i = finish_pop()) != -1)
 		{
-			if (jobs[i].run_time == 0)
+			// A job moved into a retired slot may itself be finished
+			while (i < active_jobs && jobs[i].run_time == 0)
 			{
 				// Notify the scheduler has finished
 				int job_id = jobs[i].job_id;
 				int core_id = jobs[i].core_id;
 				int new_job_id = scheduler_job_finished(jobs[i].core_id, jobs[i].job_id, time);
 
-				if (scheme == RR)
-					quantum_clock[jobs[i].core_id] = quantum;
+				// A gang job frees all its cores, the lowest of which is core_id
+				for (c = core_id, k = jobs[i].width; k > 0; c++)
+				{
+					if (core_job[c] != i)
+						continue;
+					core_job[c] = -1;
+					expiry_seq[c]++;
+					trace_stop(c, time);
+					k--;
+				}
+				telemetry_event(telemetry, TEL_FINISH, time, job_id, core_id);
 
 				// Delete the finished jobs, decrease the number of active jobs
-				if (i != active_jobs - 1)
-					memcpy(&jobs[i], &jobs[active_jobs - 1], sizeof(simulator_job_list_t));
-				active_jobs--;
+				active_jobs = retire_slot(jobs, i, active_jobs);
 				jobs_alive--;
-				i--;
 
-				// Set the new job
-				if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
+				// Set the new job(s)
+				if (gang)
+				{
+					int started = dispatch_started(jobs, active_jobs, time);
+					if (started < 0 || (new_job_id != -1 && (core_job[core_id] == -1 || jobs[core_job[core_id]].job_id != new_job_id)))
+					{
+						printf("The scheduler_job_finished() started an invalid job.\n");
+						print_available_jobs(jobs, active_jobs);
+						return 3;
+					}
+
+					if (!quiet)
+					{
+						printf("Job %d, running on core %d, finished. Core %d is now running job %d.\n", job_id, core_id, core_id, new_job_id);
+						print_started_jobs(started);
+						printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					}
+				}
+				else if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
 				{
 					printf("The scheduler_job_finished() selected an invalid job (job_id == %d).\n", new_job_id);
 					print_available_jobs(jobs, active_jobs);
@@ -273,8 +1829,18 @@ int main(int argc, char **argv)
 				}
 				else
 				{
-					printf("Job %d, running on core %d, finished. Core %d is now running job %d.\n", job_id, core_id, core_id, new_job_id);
-					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					if (new_job_id != -1)
+					{
+						start_quantum(core_id, time, jobs[core_job[core_id]].stall, quantum);
+						trace_run(core_id, new_job_id, jobs[core_job[core_id]].stall, time);
+						telemetry_event(telemetry, TEL_DISPATCH, time, new_job_id, core_id);
+					}
+
+					if (!quiet)
+					{
+						printf("Job %d, running on core %d, finished. Core %d is now running job %d.\n", job_id, core_id, core_id, new_job_id);
+						printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					}
 				}
 			}
 		}
@@ -282,138 +1848,406 @@ int main(int argc, char **argv)
 		/*
 		 * Check to see if we finished our last job.  (If we don't check here, we would run an extra time unit that will be totally idle.)
 		 */
-		if (active_jobs == 0)
+		if (active_jobs == 0 && !swf_more)
 			break;
 
 		/*
 		 * 2. Check of any quantums expired in the last time unit.
 		 */
-		if (scheme == RR)
+		while ((c = expiry_pop(time)) != -1)
 		{
-			for (i = 0; i < cores; i++)
+			// Notify the scheduler the quantum has expired
+			int core_id = c;
+			int old_job_id = jobs[core_job[core_id]].job_id;
+			int new_job_id = scheduler_quantum_expired(core_id, time);
+
+			jobs[core_job[core_id]].core_id = -1;
+			core_job[core_id] = -1;
+			trace_stop(core_id, time);
+			trace_instant("quantum expired", core_id, time, old_job_id, -1);
+
+			// Set the new job
+			if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
+			{
+				printf("The scheduler_quantum_expired() selected an invalid job (job_id == %d).\n", new_job_id);
+				print_available_jobs(jobs, active_jobs);
+				return 3;
+			}
+			else
 			{
-				if (quantum_clock[i] == 0)
+				if (new_job_id != -1)
 				{
-					for (j = 0; j < active_jobs; j++)
-					{
-						if (jobs[j].core_id == i)
-						{
-							// Notify the scheduler the quantum has expired
-							int core_id = jobs[j].core_id;
-							int old_job_id = jobs[j].job_id;
-							int new_job_id = scheduler_quantum_expired(jobs[j].core_id, time);
-
-							jobs[j].core_id = -1;
-
-							quantum_clock[core_id] = quantum;
-
-							// Set the new job
-							if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
-							{
-								printf("The scheduler_quantum_expired() selected an invalid job (job_id == %d).\n", new_job_id);
-								print_available_jobs(jobs, active_jobs);
-								return 3;
-							}
-							else
-							{
-								printf("Job %d, running on core %d, had its quantum expire. Core %d is now running job %d.\n", old_job_id, core_id, core_id, new_job_id);
-								printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
-							}
-
-							break;
-						}
-					}
+					start_quantum(core_id, time, jobs[core_job[core_id]].stall, quantum);
+					trace_run(core_id, new_job_id, jobs[core_job[core_id]].stall, time);
+					telemetry_event(telemetry, TEL_DISPATCH, time, new_job_id, core_id);
+				}
+
+				if (!quiet)
+				{
+					printf("Job %d, running on core %d, had its quantum expire. Core %d is now running job %d.\n", old_job_id, core_id, core_id, new_job_id);
+					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
 				}
 			}
 		}
 
 
 		/*
-		 * 3. Check for any new jobs that arrive in this time unit
+		 * 3. Bring cores online or take them offline as the core schedule says.
 		 */
-		for (i = 0; i < active_jobs; i++)
+		while (plan_next < plan_n && plan[plan_next].at <= time)
 		{
-			if (jobs[i].arrival_time == time)
+			if (cores == plan[plan_next].cores)
 			{
-				int new_job_core_id = scheduler_new_job(jobs[i].job_id, time, jobs[i].run_time, jobs[i].priority);
-				jobs[i].arrived = 1;
-				jobs_alive++;
+				plan_next++;
+				continue;
+			}
+
+			if (cores < plan[plan_next].cores)
+			{
+				int core_id = cores++;
+				int new_job_id = scheduler_core_online(time);
+				trace_hotplug(core_id, time, 1, cores);
 
-				if (new_job_core_id >= 0 && new_job_core_id < cores)
+				if (gang)
 				{
-					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is now running on core %d.\n",
-							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id, new_job_core_id);
-					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					int started = dispatch_started(jobs, active_jobs, time);
+					if (started < 0 || (new_job_id != -1 && (core_job[core_id] == -1 || jobs[core_job[core_id]].job_id != new_job_id)))
+					{
+						printf("The scheduler_core_online() started an invalid job.\n");
+						print_available_jobs(jobs, active_jobs);
+						return 3;
+					}
+
+					if (!quiet)
+					{
+						printf("Core %d came online. Core %d is now running job %d.\n", core_id, core_id, new_job_id);
+						print_started_jobs(started);
+						printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					}
+				}
+				else if (new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs))
+				{
+					printf("The scheduler_core_online() selected an invalid job (job_id == %d).\n", new_job_id);
+					print_available_jobs(jobs, active_jobs);
+					return 3;
+				}
+				else
+				{
+					if (new_job_id != -1)
+					{
+						start_quantum(core_id, time, jobs[core_job[core_id]].stall, quantum);
+						trace_run(core_id, new_job_id, jobs[core_job[core_id]].stall, time);
+						telemetry_event(telemetry, TEL_DISPATCH, time, new_job_id, core_id);
+					}
+
+					if (!quiet)
+					{
+						printf("Core %d came online. Core %d is now running job %d.\n", core_id, core_id, new_job_id);
+						printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+					}
+				}
+				continue;
+			}
 
-					// Find if anyone is currently using the core.
-					for (j = 0; j < active_jobs; j++)
-						if (jobs[j].core_id == new_job_core_id)
-							jobs[j].core_id = -1;
+			// The job on the core leaves every core it held and goes back to the scheduler
+			int core_id = --cores;
+			int slot = core_job[core_id];
+			int old_job_id = (slot != -1) ? jobs[slot].job_id : -1;
+			int new_core_id = scheduler_core_offline(time);
 
-					// Assign the core to the new job
-					jobs[i].core_id = new_job_core_id;
+			for (c = 0; slot != -1 && c <= core_id; c++)
+			{
+				if (core_job[c] != slot)
+					continue;
+				core_job[c] = -1;
+				expiry_seq[c]++;
+				trace_stop(c, time);
+			}
+			if (slot != -1)
+				jobs[slot].core_id = -1;
+			trace_hotplug(core_id, time, 0, cores);
 
-					if (scheme == RR)
-						quantum_clock[new_job_core_id] = quantum;
+			if (gang)
+			{
+				int started = dispatch_started(jobs, active_jobs, time);
+				if (started < 0 || new_core_id < -1 || new_core_id >= cores || (new_core_id != -1 && core_job[new_core_id] != slot))
+				{
+					printf("The scheduler_core_offline() selected an invalid core (core_id == %d).\n", new_core_id);
+					print_available_cores(cores);
+					return 3;
 				}
-				else if (new_job_core_id == -1)
+
+				if (!quiet)
 				{
-					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is set to idle (-1).\n",
-							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id);
+					printf("Core %d went offline. Job %d, which was running on it, is now running on core %d.\n", core_id, old_job_id, new_core_id);
+					print_started_jobs(started);
 					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
 				}
+				continue;
+			}
+
+			if (new_core_id < -1 || new_core_id >= cores || (new_core_id != -1 && slot == -1))
+			{
+				printf("The scheduler_core_offline() selected an invalid core (core_id == %d).\n", new_core_id);
+				print_available_cores(cores);
+				return 3;
+			}
+
+			if (!quiet)
+			{
+				printf("Core %d went offline. Job %d, which was running on it, is now running on core %d.\n", core_id, old_job_id, new_core_id);
+				printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+			}
+
+			// Like an arrival, the job may take the core of one it outranks
+			if (new_core_id != -1)
+			{
+				if (core_job[new_core_id] != -1)
+				{
+					jobs[core_job[new_core_id]].core_id = -1;
+					trace_stop(new_core_id, time);
+					trace_instant("preempt", new_core_id, time, jobs[core_job[new_core_id]].job_id, old_job_id);
+					telemetry_event(telemetry, TEL_PREEMPT, time, jobs[core_job[new_core_id]].job_id, new_core_id);
+				}
+
+				dispatch_job(jobs, slot, new_core_id);
+				start_quantum(new_core_id, time, jobs[slot].stall, quantum);
+				trace_run(new_core_id, old_job_id, jobs[slot].stall, time);
+				telemetry_event(telemetry, TEL_DISPATCH, time, old_job_id, new_core_id);
+			}
+		}
+
+
+		/*
+		 * 4. Check for any new jobs that arrive in this time unit
+		 */
+		int arriving_n = 0;
+		while (swf_more && swf_next.arrival_time <= time)
+		{
+			// Append the job to the system, growing the arrays as needed
+			if (active_jobs == jobs_ct)
+			{
+				jobs_ct *= 2;
+				jobs = realloc(jobs, jobs_ct * sizeof(simulator_job_list_t));
+			}
+			if (job_total == slot_ct)
+			{
+				slot_ct *= 2;
+				job_slot = realloc(job_slot, slot_ct * sizeof(int));
+			}
+			if (arriving_n == arriving_ct)
+			{
+				arriving_ct *= 2;
+				arriving = realloc(arriving, arriving_ct * sizeof(int));
+			}
+			if (!jobs || !job_slot || !arriving)
+			{
+				fprintf(stderr, "Out of memory.\n");
+				return 3;
+			}
+
+			if (!gang_capable())
+				swf_next.width = 1;
+			if (swf_next.width > max_cores)
+			{
+				fprintf(stderr, "Job %d needs %d cores, only %d are available.\n", job_total, swf_next.width, max_cores);
+				return 1;
+			}
+
+			swf_next.job_id = job_total;
+			swf_next.arrival_time = time;
+			jobs[active_jobs] = swf_next;
+			job_slot[job_total++] = active_jobs;
+			arriving[arriving_n++] = active_jobs++;
+			swf_more = swf_read_job(&swf_next);
+		}
+		while (arrival_next < arrival_ct && arrivals[arrival_next].at <= time)
+		{
+			if (arrivals[arrival_next].at == time)
+				arriving[arriving_n++] = job_slot[arrivals[arrival_next].job_id];
+			arrival_next++;
+		}
+		while ((c = retry_pop(time)) != -1)
+		{
+			if (arriving_n == arriving_ct)
+			{
+				arriving_ct *= 2;
+				arriving = realloc(arriving, arriving_ct * sizeof(int));
+			}
+			arriving[arriving_n++] = job_slot[c];
+		}
+		qsort(arriving, arriving_n, sizeof(int), slot_compare);
+
+		// Rejected jobs are retired once every arrival is through, their slots gather at the front of arriving
+		int rejected_n = 0;
+
+		for (j = 0; j < arriving_n; j++)
+		{
+			i = arriving[j];
+			int new_job_core_id = scheduler_new_job_tenant(jobs[i].job_id, time, jobs[i].run_time, jobs[i].priority,
+					jobs[i].deadline, jobs[i].width, jobs[i].job_class, jobs[i].estimate, jobs[i].tenant);
+
+			if (new_job_core_id == JOB_REJECTED || new_job_core_id == JOB_DEFERRED)
+			{
+				if (new_job_core_id == JOB_REJECTED)
+					arriving[rejected_n++] = i;
 				else
+					retry_push(time + retry_delay, jobs[i].job_id);
+				trace_instant((new_job_core_id == JOB_REJECTED) ? "rejected" : "deferred", -1, time, jobs[i].job_id, -1);
+
+				if (!quiet)
+				{
+					if (new_job_core_id == JOB_REJECTED)
+						printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d was rejected.\n",
+								jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id);
+					else
+						printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is deferred until time %d.\n",
+								jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id, time + retry_delay);
+					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+				}
+				continue;
+			}
+
+			if (jobs[i].width > 1)
+				gang = 1;
+			jobs[i].arrived = 1;
+			jobs_alive++;
+			trace_instant("arrival", -1, time, jobs[i].job_id, -1);
+			telemetry_event(telemetry, TEL_ARRIVAL, time, jobs[i].job_id, -1);
+
+			// Gang jobs never preempt, but the arrival may start other queued jobs too
+			if (gang)
+			{
+				int started = dispatch_started(jobs, active_jobs, time);
+				if (started < 0 || new_job_core_id < -1 || new_job_core_id >= cores
+						|| (new_job_core_id != -1 && core_job[new_job_core_id] != i))
 				{
 					printf("The scheduler_new_job() selected an invalid core (core_id == %d).\n", new_job_core_id);
 					print_available_cores(cores);
 					return 3;
 				}
+
+				if (!quiet)
+				{
+					if (new_job_core_id != -1)
+						printf("A new job, job %d (running time=%d, priority=%d, cores=%d), arrived. Job %d is now running on core %d.\n",
+								jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].width, jobs[i].job_id, new_job_core_id);
+					else
+						printf("A new job, job %d (running time=%d, priority=%d, cores=%d), arrived. Job %d is set to idle (-1).\n",
+								jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].width, jobs[i].job_id);
+					print_started_jobs(started);
+					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+				}
+				continue;
+			}
+
+			if (new_job_core_id >= 0 && new_job_core_id < cores)
+			{
+				if (!quiet)
+				{
+					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is now running on core %d.\n",
+							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id, new_job_core_id);
+					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+				}
+
+				// Find if anyone is currently using the core.
+				if (core_job[new_job_core_id] != -1)
+				{
+					jobs[core_job[new_job_core_id]].core_id = -1;
+					trace_stop(new_job_core_id, time);
+					trace_instant("preempt", new_job_core_id, time, jobs[core_job[new_job_core_id]].job_id, jobs[i].job_id);
+					telemetry_event(telemetry, TEL_PREEMPT, time, jobs[core_job[new_job_core_id]].job_id, new_job_core_id);
+				}
+
+				// Assign the core to the new job
+				dispatch_job(jobs, i, new_job_core_id);
+				start_quantum(new_job_core_id, time, jobs[i].stall, quantum);
+				trace_run(new_job_core_id, jobs[i].job_id, jobs[i].stall, time);
+				telemetry_event(telemetry, TEL_DISPATCH, time, jobs[i].job_id, new_job_core_id);
+			}
+			else if (new_job_core_id == -1)
+			{
+				if (!quiet)
+				{
+					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is set to idle (-1).\n",
+							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id);
+					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
+				}
+			}
+			else
+			{
+				printf("The scheduler_new_job() selected an invalid core (core_id == %d).\n", new_job_core_id);
+				print_available_cores(cores);
+				return 3;
 			}
 		}
+		while (rejected_n > 0)
+			active_jobs = retire_slot(jobs, arriving[--rejected_n], active_jobs);
 
 
 		/*
-		 * 4. Run the time unit.
+		 * 5. Run the time unit.
 		 */
-		char time_string[cores][11];
+		char time_string[max_cores][11];
 		int cores_working = 0;
 
-		for (i = 0; i < cores; i++)
+		for (i = 0; i < max_cores; i++)
 			time_string[i][0] = '\0';
 
-		for (i = 0; i < active_jobs; i++)
+		for (j = 0; j < cores; j++)
 		{
-			if (jobs[i].core_id != -1)
+			i = core_job[j];
+			if (i != -1)
 			{
 				cores_working++;
-				jobs[i].run_time--;
-				quantum_clock[jobs[i].core_id]--;
+				// The quantum starts once the switch overhead has been paid; a gang job advances
+				// on its lead core only
+				if (jobs[i].core_id == j && jobs[i].stall > 0)
+				{
+					jobs[i].stall--;
+					overhead_time++;
+				}
+				else if (jobs[i].core_id == j)
+				{
+					// Retire this core's share of work, finishing once none is left
+					jobs[i].work -= core_speed[jobs[i].core_id];
+					jobs[i].run_time = (jobs[i].work <= 0) ? 0 : (int)((jobs[i].work + SPEED_UNIT - 1) / SPEED_UNIT);
+					if (jobs[i].run_time == 0)
+						finish_push(i);
+				}
 
-				assert(time_string[jobs[i].core_id][0] == '\0');
+				assert(time_string[j][0] == '\0');
 
-				if (jobs[i].job_id < 10)
-					sprintf(time_string[jobs[i].core_id], "%d", jobs[i].job_id);
-				else if (jobs[i].job_id < 10 + 26)
-					sprintf(time_string[jobs[i].core_id], "%c", jobs[i].job_id - 10 + 'a');
-				else if (jobs[i].job_id < 10 + 26 + 26)
-					sprintf(time_string[jobs[i].core_id], "%c", jobs[i].job_id - 10 - 26 + 'A');
-				else
-					snprintf(time_string[jobs[i].core_id], 10, "(%d)", jobs[i].job_id);
+				// The timing diagram is skipped in quiet mode, it grows with the trace
+				if (!quiet)
+				{
+					if (jobs[i].job_id < 10)
+						sprintf(time_string[j], "%d", jobs[i].job_id);
+					else if (jobs[i].job_id < 10 + 26)
+						sprintf(time_string[j], "%c", jobs[i].job_id - 10 + 'a');
+					else if (jobs[i].job_id < 10 + 26 + 26)
+						sprintf(time_string[j], "%c", jobs[i].job_id - 10 - 26 + 'A');
+					else
+						snprintf(time_string[j], 10, "(%d)", jobs[i].job_id);
+				}
 			}
 		}
+		trace_counter(time, scheduler_queue_depth(), cores_working);
+		if (telemetry != NULL)
+			telemetry_counters(telemetry, time, scheduler_queue_depth(), cores_working);
 
-		for (i = 0; i < cores; i++)
+		for (i = 0; i < max_cores && !quiet; i++)
 		{
-			// If the core is idle, print a '-'
+			// If the core is idle, print a '-', or a '.' while it is offline
 			if (time_string[i][0] == '\0')
-				strcpy(time_string[i], "-");
+				strcpy(time_string[i], (i < cores) ? "-" : ".");
 
 			// Ensure we have enough memory
 			while (strlen(core_timing_diagram[i]) + strlen(time_string[i]) >= (unsigned int)core_timing_diagram_size)
 			{
 				core_timing_diagram_size *= 2;
 
-				for (j = 0; j < cores; j++)
+				for (j = 0; j < max_cores; j++)
 				{
 					core_timing_diagram[j] = realloc(core_timing_diagram[j], core_timing_diagram_size + 1);
 
@@ -430,28 +2264,40 @@ int main(int argc, char **argv)
 
 
 		/*
-		 * 5. Print data!
+		 * 6. Print data!
 		 */
-		printf("At the end of time unit %d...\n", time);
+		if (!quiet)
+		{
+			printf("At the end of time unit %d...\n", time);
 
-		for (i = 0; i < cores; i++)
-			printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
+			for (i = 0; i < max_cores; i++)
+				printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
 
-		printf("\n");
+			printf("\n");
 
-		printf("  Queue: ");
-		scheduler_show_queue();
-		printf("\n");
-		printf("\n");
+			printf("  Queue: ");
+			scheduler_show_queue();
+			printf("\n");
+			printf("\n");
+		}
 
 
 		/*
-		 * 6. Sanity Checking
+		 * 7. Sanity Checking
 		 *
 		 * - If there's a job alive (needing to be ran) and all CPUs are idle, the scheduler failed to schedule properly.
+		 *   (Unless more cores are still to come online for a job too wide for those online.)
 		 */
-		if (jobs_alive > 0 && cores_working == 0)
+		if (jobs_alive > 0 && cores_working == 0 && plan_next == plan_n)
 		{
+			for (i = 0; i < active_jobs; i++)
+			{
+				if (jobs[i].arrived && jobs[i].width > cores)
+				{
+					fprintf(stderr, "Job %d needs %d cores, the core schedule leaves only %d online.\n", jobs[i].job_id, jobs[i].width, cores);
+					return 1;
+				}
+			}
 			printf("All cores are idle and at least one job remains unscheduled.\n");
 			print_available_jobs(jobs, active_jobs);
 			return 3;
@@ -459,26 +2305,155 @@ int main(int argc, char **argv)
 
 
 		/*
-		 * 7. Increase time
+		 * 8. Increase time
 		 */
 		time++;
 	}
 
 
-	printf("FINAL TIMING DIAGRAM:\n");
-	for (i = 0; i < cores; i++)
-		printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
+	trace_end();
+	telemetry_close(telemetry, telemetry_name);
+
+	if (!quiet)
+	{
+		printf("FINAL TIMING DIAGRAM:\n");
+		for (i = 0; i < max_cores; i++)
+			printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
 
-	printf("\n");
+		printf("\n");
+	}
+	else
+		printf("Simulated %d job(s) in %d time unit(s).\n\n", job_total, time);
 	printf("Average Waiting Time: %.2f\n", scheduler_average_waiting_time());
 	printf("Average Turnaround Time: %.2f\n", scheduler_average_turnaround_time());
 	printf("Average Response Time: %.2f\n", scheduler_average_response_time());
 
-	scheduler_clean_up();
+	if (prediction != PREDICT_ORACLE)
+	{
+		printf("Average Prediction Error: %.2f\n", scheduler_average_prediction_error());
+		printf("Prediction Bias: %.2f\n", scheduler_prediction_bias());
+	}
+
+	if (gang)
+	{
+		sched_stats_t stats;
+		scheduler_get_stats(&stats);
+		printf("Average Bounded Slowdown: %.2f\n", scheduler_average_bounded_slowdown());
+		printf("Core Utilization: %.2f%%\n", stats.utilization * 100.0);
+	}
+
+	if (switch_cost > 0 || migrate_cost > 0)
+		printf("Switch Overhead: %lld time units\n", overhead_time);
+
+	if (plan_n > 0)
+	{
+		// Cores accrue busy or idle time only while online
+		sched_stats_t stats;
+		long long core_time = 0;
+		scheduler_get_stats(&stats);
+		for (i = 0; i < stats.cores; i++)
+			core_time += stats.busy[i] + stats.idle[i];
+		printf("Average Cores Online: %.2f\n", (stats.elapsed == 0) ? (double)cores : (double)core_time / stats.elapsed);
+	}
+
+	if (age > 0)
+		printf("Maximum Waiting Time: %d\n", scheduler_max_waiting_time());
+
+	if (has_deadlines)
+	{
+		printf("Deadline Misses: %d of %d\n", scheduler_deadline_misses(), scheduler_deadline_jobs());
+		printf("Total Tardiness: %lld\n", scheduler_total_tardiness());
+	}
+
+	if (admission)
+	{
+		// Goodput counts only the jobs admitted and run to completion
+		sched_stats_t stats;
+		latency_t lat;
+		scheduler_get_stats(&stats);
+		scheduler_latency_stats(METRIC_TURN, &lat);
+		printf("Rejected Jobs: %lld of %d\n", stats.rejected, job_total);
+		printf("Deferrals: %lld\n", stats.deferrals);
+		printf("Goodput: %.4f jobs per time unit\n", (time == 0) ? 0.0 : (double)lat.n / time);
+	}
+
+	if (percentiles)
+	{
+		const char *names[] = { "Waiting", "Response", "Turnaround" };
+		latency_t lat;
+
+		printf("\n%-10s %6s %6s %6s %6s %6s %6s %9s %9s\n", "Time", "min", "p50", "p90", "p99", "p99.9", "max", "mean", "stddev");
+		for (i = METRIC_WAIT; i <= METRIC_TURN; i++)
+		{
+			scheduler_latency_stats(i, &lat);
+			printf("%-10s %6d %6d %6d %6d %6d %6d %9.2f %9.2f\n", names[i],
+					lat.min, lat.p50, lat.p90, lat.p99, lat.p999, lat.max, lat.mean, lat.stddev);
+		}
+	}
+
+	// Each tenant's share of the core time its jobs received, once jobs of two tenants have run
+	tenant_stats_t ts;
+	long long service = 0;
+	int tenants_run = 0;
+
+	for (i = 0; i < scheduler_tenant_count(); i++)
+	{
+		scheduler_tenant_stats(i, &ts);
+		service += ts.service;
+		tenants_run += (ts.turnaround.n > 0);
+	}
+
+	if (weight_n > 0 || tenants_run > 1)
+	{
+		printf("\n%-10s %6s %6s %7s %10s %6s\n", "Tenant", "weight", "jobs", "share", "turnaround", "p99");
+		for (i = 0; i < scheduler_tenant_count(); i++)
+		{
+			scheduler_tenant_stats(i, &ts);
+			if (ts.turnaround.n > 0)
+				printf("%-10d %6d %6lld %6.2f%% %10.2f %6d\n", i, ts.weight, ts.turnaround.n,
+						(service == 0) ? 0.0 : ts.service * 100.0 / service, ts.turnaround.mean, ts.turnaround.p99);
+		}
+	}
 
+	if (verbose)
+	{
+		sched_stats_t stats;
+		scheduler_get_stats(&stats);
+
+		printf("\nScheduler Statistics:\n");
+		printf("  Context Switches: %lld\n", stats.switches);
+		printf("  Preemptions: %lld\n", stats.preemptions);
+		printf("  Migrations: %lld\n", stats.migrations);
+		printf("  Quantum Re-dispatches: %lld\n", stats.redispatches);
+		printf("  Queue Comparisons: %lld\n", stats.comparisons);
+		printf("  Queue Depth: max %d, mean %.2f, p50 %d, p90 %d, p99 %d\n", stats.max_depth, stats.avg_depth,
+				stats.depth.p50, stats.depth.p90, stats.depth.p99);
+		for (i = 0; i < stats.cores; i++)
+			printf("  Core %2d: busy %lld, idle %lld\n", i, stats.busy[i], stats.idle[i]);
+		printf("  Utilization: %.2f%% over %d time units\n", stats.utilization * 100.0, stats.elapsed);
+	}
+
+	scheduler_clean_up();
 
-	free(quantum_clock);
-	for (i=0; i < cores; i++)
+	if (swf_file != NULL)
+		fclose(swf_file);
+
+	free(core_last_job);
+	free(core_job);
+	free(gang_started);
+	free(gang_cores);
+	free(expiry_seq);
+	free(expiry_heap);
+	free(retry_heap);
+	free(rate_limits);
+	free(weights);
+	free(finish_heap);
+	free(job_slot);
+	free(arrivals);
+	free(arriving);
+	free(core_speed);
+	free(plan);
+	for (i=0; i < max_cores; i++)
 		free(core_timing_diagram[i]);
 	free(core_timing_diagram);
 	free(jobs);